@@ -20,5 +20,21 @@ extern int32_t ece391_close (int32_t fd);
 extern int32_t ece391_getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t ece391_vidmap (uint8_t** screen_start);
 
+/*
+ * Waits until at least one descriptor in fds is ready for the events it
+ * asks for, or until timeout milliseconds pass (0 only checks, negative
+ * waits forever).  Fills in revents and returns the number of ready
+ * descriptors, 0 on timeout.  The RTC is ready once per virtual tick and
+ * stdin once enter is pressed; files are always ready.
+ */
+#define ECE391_POLLIN  0x1
+#define ECE391_POLLOUT 0x4
+typedef struct ece391_pollfd {
+	int32_t fd;
+	int16_t events;
+	int16_t revents;
+} ece391_pollfd_t;
+extern int32_t ece391_poll (ece391_pollfd_t* fds, int32_t nfds, int32_t timeout);
+
 #endif /* ECE391SYSCALL_H */
 
@@ -11,5 +11,6 @@
 #define SYS_VIDMAP  8
 #define SYS_SET_HANDLER  9
 #define SYS_SIGRETURN  10
+#define SYS_POLL    19
 
 #endif /* ECE391SYSNUM_H */
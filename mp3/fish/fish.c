@@ -8,6 +8,7 @@
 uint8_t *vmem_base_addr;
 uint8_t *mp1_set_video_mode (void);
 void add_frames(uint8_t *, uint8_t *, int32_t);
+int32_t run_ticks(int32_t);
 void ece391_memset(void* memory, char c, int n);
 int32_t ece391_memcpy(void* dest, const void* src, int32_t n);
 
@@ -22,7 +23,7 @@ static struct mp1_blink_struct blink_array[80*25];
 
 int main(void)
 {
-    int rtc_fd, ret_val, i, garbage;
+    int rtc_fd, ret_val;
     struct mp1_blink_struct blink_struct;
 
     ece391_memset(blink_array, 0, sizeof(struct mp1_blink_struct)*80*25);
@@ -38,9 +39,8 @@ int main(void)
     ret_val = 32;
     ret_val = ece391_write(rtc_fd, &ret_val, 4);
 
-    for(i=0; i<WAIT; i++) {
-        ece391_read(rtc_fd, &garbage, 4);
-        mp1_rtc_tasklet(garbage);
+    if(run_ticks(rtc_fd)) {
+        goto done;
     }
 
     blink_struct.on_char = 'I';
@@ -51,30 +51,61 @@ int main(void)
 
     mp1_ioctl((unsigned long)&blink_struct, RTC_ADD);
 
-    for(i=0; i<WAIT; i++) {
-        ece391_read(rtc_fd, &garbage, 4);
-        mp1_rtc_tasklet(garbage);
+    if(run_ticks(rtc_fd)) {
+        goto done;
     }
 
     mp1_ioctl((40 << 16 | (6*80+60)), RTC_SYNC);
 
-    for(i=0; i<WAIT; i++) {
-        ece391_read(rtc_fd, &garbage, 4);
-        mp1_rtc_tasklet(garbage);
+    if(run_ticks(rtc_fd)) {
+        goto done;
     }
 
     mp1_ioctl(6*80+60, RTC_REMOVE);
 
-    for(i=0; i<WAIT; i++) {
-        ece391_read(rtc_fd, &garbage, 4);
-        mp1_rtc_tasklet(garbage);
+    if(run_ticks(rtc_fd)) {
+        goto done;
     }
 
+done:
     ece391_close(rtc_fd);
 
     return 0;
 }
 
+/*
+ * Runs the blink tasklet for WAIT RTC ticks, sleeping in poll between
+ * them.  Returns 1 as soon as enter is pressed, 0 otherwise.
+ */
+int32_t
+run_ticks(int32_t rtc_fd)
+{
+    ece391_pollfd_t fds[2];
+    uint8_t line[128];
+    int32_t i, garbage;
+
+    fds[0].fd = rtc_fd;
+    fds[0].events = ECE391_POLLIN;
+    fds[1].fd = 0;
+    fds[1].events = ECE391_POLLIN;
+
+    for(i=0; i<WAIT; i++) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        (void)ece391_poll(fds, 2, -1);
+
+        if(fds[1].revents & ECE391_POLLIN) {
+            ece391_memset(line, 0, sizeof(line));
+            (void)ece391_read(0, line, sizeof(line));
+            return 1;
+        }
+
+        ece391_read(rtc_fd, &garbage, 4);
+        mp1_rtc_tasklet(garbage);
+    }
+    return 0;
+}
+
 void
 add_frames(uint8_t *f0, uint8_t *f1, int32_t rtc_fd)
 {
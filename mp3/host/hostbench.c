@@ -0,0 +1,235 @@
+/*
+ * hostbench - times the kernel's file system, parsing and string hot paths
+ * on the host, against a file system image loaded into memory.
+ *
+ * Usage: hostbench <image>
+ *
+ * Each benchmark runs for about BENCH_NS and prints nanoseconds per
+ * operation. Results are checked as they run, and the exit status is 1 if
+ * any of them came out wrong.
+ */
+
+#include "hostsys.h"
+#include "lib.h"
+#include "filesys.h"
+#include "parsing.h"
+#include "pcb.h"
+
+#define BENCH_NS 50000000 // run each benchmark for about 50 ms
+#define BENCH_BATCH 256 // operations between clock reads, which are real system calls here
+#define BENCH_NAMES 64 // names sampled across the directory
+#define IMAGE_MAX (8 * 1024 * 1024)
+
+extern pcb_t host_pcb;
+
+static uint8_t image[IMAGE_MAX] __attribute__((aligned(FS_BLOCK_SIZE)));
+static int8_t names[BENCH_NAMES][FNAME_MAX_LEN + 1];
+static uint8_t buf[INODE_BLOCKS * FS_BLOCK_SIZE];
+static uint8_t src[FS_BLOCK_SIZE];
+static int failed = 0;
+
+/*
+ * report
+ *   DESCRIPTION: Prints one benchmark result as ns/op with one decimal
+ *   INPUTS: name - what was measured
+ *			 ops - number of operations
+ *			 ns - elapsed nanoseconds, under 429 ms so ns * 10 fits
+ *			 ok - 0 if the benchmark saw a wrong result
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+static void report (const int8_t * name, uint32_t ops, uint32_t ns, int ok) {
+	uint32_t tenths = (ns * 10) / ops;
+
+	host_puts(name);
+	host_puts(": ");
+	host_putu(tenths / 10);
+	host_puts(".");
+	host_putu(tenths % 10);
+	host_puts(" ns/op (");
+	host_putu(ops);
+	host_puts(ok ? " ops)\n" : " ops) FAILED\n");
+
+	if (!ok) {
+		failed = 1;
+	}
+}
+
+/*
+ * load_image
+ *   DESCRIPTION: Reads the image into memory and hands it to filesys_init as module 0
+ *   INPUTS: path - image file
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 on failure, 0 on success
+ */
+static int32_t load_image (const int8_t * path) {
+	module_t module;
+	int32_t fd, cnt;
+	uint32_t size = 0;
+
+	fd = host_open(path);
+	if (fd < 0) {
+		return -1;
+	}
+
+	while (0 < (cnt = host_read(fd, image + size, IMAGE_MAX - size))) {
+		size += cnt;
+	}
+	host_close(fd);
+	if (cnt < 0 || size < FS_BLOCK_SIZE) {
+		return -1;
+	}
+
+	module.mod_start = (uint32_t) image;
+	module.mod_end = (uint32_t) image + size;
+	filesys_init(&module);
+
+	return 0;
+}
+
+int main (int argc, int8_t ** argv) {
+	uint32_t start, elapsed, ops;
+	uint32_t count, entries, step, largest, length;
+	int32_t i, len;
+	int ok;
+	dentry_t dentry;
+	int8_t command[ARG_LIMIT];
+	uint8_t args[ARG_LIMIT];
+
+	if (argc != 2 || load_image(argv[1]) == -1) {
+		host_puts("usage: hostbench <image>\n");
+		return 1;
+	}
+
+	// sample names across the directory and find the largest file
+	for (entries = 0; read_dentry_by_index(entries, &dentry) != -1; entries++);
+	step = (entries + BENCH_NAMES - 1) / BENCH_NAMES;
+	largest = 0;
+	length = 0;
+	for (count = 0; count * step < entries; count++) {
+		read_dentry_by_index(count * step, &dentry);
+		memcpy(names[count], dentry.file_name, FNAME_MAX_LEN);
+		names[count][FNAME_MAX_LEN] = '\0';
+	}
+	for (i = 0; i < entries; i++) {
+		read_dentry_by_index(i, &dentry);
+		if (dentry.file_type == 2 && inode_length(dentry.inode_num) > (int32_t) length) {
+			largest = dentry.inode_num;
+			length = inode_length(dentry.inode_num);
+		}
+	}
+	host_puts("directory entries: ");
+	host_putu(entries);
+	host_puts(", largest file: ");
+	host_putu(length);
+	host_puts(" bytes\n");
+
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			ok &= (read_dentry_by_name((uint8_t*) names[i % count], &dentry) == 0);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("read_dentry_by_name hit", ops, elapsed, ok);
+
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			ok &= (read_dentry_by_name((uint8_t*) "no_such_file.txt", &dentry) == -1);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("read_dentry_by_name miss", ops, elapsed, ok);
+
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		ok &= (read_data(largest, 0, buf, length) == length);
+		ops++;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("read_data whole largest file", ops, elapsed, ok);
+
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			ok &= (read_data(largest, ((ops + i) * 97) % length, buf, 1) == 1);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("read_data 1 byte", ops, elapsed, ok);
+
+	// fdir_read reads one name per call from fd 2 of the mocked pcb
+	host_pcb.file_array[2].flags = 1;
+	host_pcb.file_array[2].file_pos = 0;
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			len = fdir_read(2, buf, FNAME_MAX_LEN);
+			ok &= (len >= 0);
+			if (len == 0) {
+				host_pcb.file_array[2].file_pos = 0;
+			}
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	host_pcb.file_array[2].flags = 0;
+	report("fdir_read", ops, elapsed, ok);
+
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			parseString("grep -i verylargetextwithverylongname.txt", command, args);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	ok = (strncmp(command, "grep", 5) == 0 && strncmp((int8_t*) args, "-i verylargetextwithverylongname.txt", 37) == 0);
+	report("parseString", ops, elapsed, ok);
+
+	memset(src, 'a', sizeof(src));
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			memcpy(buf, src, FS_BLOCK_SIZE);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("memcpy 4096 bytes", ops, elapsed, buf[FS_BLOCK_SIZE - 1] == 'a');
+
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			memcpy(buf + 1, src + 3, FNAME_MAX_LEN);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("memcpy 32 bytes unaligned", ops, elapsed, buf[FNAME_MAX_LEN] == 'a');
+
+	// differ only in the last byte compared
+	buf[FNAME_MAX_LEN - 1] = 'b';
+	ok = 1;
+	ops = 0;
+	start = host_clock_ns();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			ok &= (strncmp((int8_t*) buf, (int8_t*) src, FNAME_MAX_LEN) != 0);
+		}
+		ops += BENCH_BATCH;
+	} while ((elapsed = host_clock_ns() - start) < BENCH_NS);
+	report("strncmp 32 bytes", ops, elapsed, ok);
+
+	return failed;
+}
@@ -0,0 +1,67 @@
+#include "hostsys.h"
+#include "lib.h"
+
+/*
+ * host_syscall
+ *   DESCRIPTION: Makes a Linux system call through int 0x80
+ *   INPUTS: num - system call number
+ *			 a, b, c - first three arguments
+ *   OUTPUTS: none
+ *   RETURN VALUE: the call's return value, negative errno on failure
+ */
+static int32_t host_syscall (uint32_t num, uint32_t a, uint32_t b, uint32_t c) {
+	int32_t ret;
+
+	asm volatile ("int $0x80"
+		: "=a" (ret)
+		: "a" (num), "b" (a), "c" (b), "d" (c)
+		: "memory");
+
+	return ret;
+}
+
+void host_exit (int32_t status) {
+	host_syscall(HOST_SYS_EXIT, status, 0, 0);
+	while (1);
+}
+
+int32_t host_open (const int8_t * path) {
+	return host_syscall(HOST_SYS_OPEN, (uint32_t) path, 0, 0); // O_RDONLY
+}
+
+int32_t host_read (int32_t fd, void * buf, uint32_t nbytes) {
+	return host_syscall(HOST_SYS_READ, fd, (uint32_t) buf, nbytes);
+}
+
+int32_t host_write (int32_t fd, const void * buf, uint32_t nbytes) {
+	return host_syscall(HOST_SYS_WRITE, fd, (uint32_t) buf, nbytes);
+}
+
+int32_t host_close (int32_t fd) {
+	return host_syscall(HOST_SYS_CLOSE, fd, 0, 0);
+}
+
+/*
+ * host_clock_ns
+ *   DESCRIPTION: Reads the monotonic clock
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: nanoseconds, wrapping every 4.29 seconds, so only differences are meaningful
+ */
+uint32_t host_clock_ns (void) {
+	int32_t ts[2]; // tv_sec, tv_nsec
+
+	host_syscall(HOST_SYS_CLOCK_GETTIME, HOST_CLOCK_MONOTONIC, (uint32_t) ts, 0);
+
+	return ts[0] * 1000000000U + ts[1];
+}
+
+void host_puts (const int8_t * s) {
+	host_write(1, s, strlen(s));
+}
+
+void host_putu (uint32_t value) {
+	int8_t buf[11];
+
+	host_puts(itoa(value, buf, 10));
+}
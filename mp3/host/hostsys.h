@@ -0,0 +1,24 @@
+#ifndef _HOSTSYS_H
+#define _HOSTSYS_H
+
+#include "types.h"
+
+// Linux i386 system call numbers
+#define HOST_SYS_EXIT 1
+#define HOST_SYS_READ 3
+#define HOST_SYS_WRITE 4
+#define HOST_SYS_OPEN 5
+#define HOST_SYS_CLOSE 6
+#define HOST_SYS_CLOCK_GETTIME 265
+#define HOST_CLOCK_MONOTONIC 1
+
+extern void host_exit (int32_t status);
+extern int32_t host_open (const int8_t * path);
+extern int32_t host_read (int32_t fd, void * buf, uint32_t nbytes);
+extern int32_t host_write (int32_t fd, const void * buf, uint32_t nbytes);
+extern int32_t host_close (int32_t fd);
+extern uint32_t host_clock_ns (void);
+extern void host_puts (const int8_t * s);
+extern void host_putu (uint32_t value);
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Stand-ins for the parts of the kernel that filesys.c and lib.c link
+ * against but that the host harness does not build.
+ */
+
+#include "types.h"
+#include "pcb.h"
+#include "rtc.h"
+#include "sysstat.h"
+
+// Terminal state read by lib.c's cursor code
+int current_terminal = 0;
+int screen_x_cache[3] = {0, 0, 0};
+int screen_y_cache[3] = {0, 0, 0};
+
+// The one process the harness runs as
+pcb_t host_pcb;
+
+pcb_t * get_pcb () {
+	return &host_pcb;
+}
+
+// The RTC is only reached through the operations table, which the harness never opens
+int32_t open_rtc (const uint8_t* filename) {
+	return -1;
+}
+
+int32_t close_rtc (uint32_t fd) {
+	return 0;
+}
+
+int32_t read_rtc (uint32_t fd, void* buf, uint32_t nbytes) {
+	return -1;
+}
+
+int32_t write_rtc (uint32_t fd, const void* buf, uint32_t nbytes) {
+	return -1;
+}
+
+int32_t poll_rtc (uint32_t fd) {
+	return 0;
+}
+
+// Nor is the sysstat file, which needs the system call linkage
+int32_t sysstat_open (const uint8_t* filename) {
+	return -1;
+}
+
+int32_t sysstat_close (uint32_t fd) {
+	return 0;
+}
+
+int32_t sysstat_read (uint32_t fd, void* buf, uint32_t nbytes) {
+	return -1;
+}
+
+int32_t sysstat_write (uint32_t fd, const void* buf, uint32_t nbytes) {
+	return -1;
+}
+
+int32_t sysstat_poll (uint32_t fd) {
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include "blockcache.h"
+#include "lib.h"
+
+// Most recently decoded blocks of compressed files
+static blockcache_t blockcache[BLOCKCACHE_ENTRIES];
+static uint32_t blockcache_clock = 0;
+
+uint32_t blockcache_hits = 0;
+uint32_t blockcache_misses = 0;
+
+/*
+ * lz_decode
+ *   DESCRIPTION: Decodes one LZ4-style block. The block is a list of sequences, each a token
+ *                byte (high nibble literal count, low nibble match length - 4), the literal count
+ *                extended with 255-valued bytes, the literals, then a 2-byte little-endian match
+ *                offset and the match length extended the same way. The last sequence stops
+ *                after its literals
+ *   INPUTS: src - encoded block
+ *			 src_len - number of encoded bytes
+ *			 dst_len - size of dst
+ *   OUTPUTS: dst - buffer for the decoded bytes
+ *   RETURN VALUE: number of decoded bytes, -1 if the block is malformed
+ */
+int32_t lz_decode (const uint8_t * src, uint32_t src_len, uint8_t * dst, uint32_t dst_len) {
+	uint32_t in = 0;
+	uint32_t out = 0;
+	uint32_t count;
+	uint32_t offset;
+	uint8_t token;
+	uint8_t ext;
+
+	while (in < src_len) {
+		token = src[in++];
+
+		// literals
+		count = token >> 4;
+		if (count == 15) {
+			do {
+				if (in >= src_len) {
+					return -1;
+				}
+				ext = src[in++];
+				count += ext;
+			} while (ext == 255);
+		}
+		if (count > src_len - in || count > dst_len - out) {
+			return -1;
+		}
+		memcpy(dst + out, src + in, count);
+		in += count;
+		out += count;
+
+		// last sequence has no match
+		if (in == src_len) {
+			break;
+		}
+
+		// match
+		if (src_len - in < 2) {
+			return -1;
+		}
+		offset = src[in] | (src[in + 1] << 8);
+		in += 2;
+		if (offset == 0 || offset > out) {
+			return -1;
+		}
+
+		count = (token & 0x0F) + 4;
+		if ((token & 0x0F) == 15) {
+			do {
+				if (in >= src_len) {
+					return -1;
+				}
+				ext = src[in++];
+				count += ext;
+			} while (ext == 255);
+		}
+		if (count > dst_len - out) {
+			return -1;
+		}
+
+		// byte at a time, matches may overlap their own output
+		for (; count > 0; count--, out++) {
+			dst[out] = dst[out - offset];
+		}
+	}
+
+	return out;
+}
+
+/*
+ * blockcache_get
+ *   DESCRIPTION: Finds a decoded block of a compressed file, decoding it into the least
+ *                recently used entry on a miss. Blocks whose encoded size equals their
+ *                length were stored raw and are copied as is
+ *   INPUTS: inode - inode of the file
+ *			 index - which block, within the inode structure
+ *			 src - encoded block in the file system module
+ *			 src_len - number of encoded bytes
+ *			 length - number of decoded bytes expected
+ *   OUTPUTS: none
+ *   RETURN VALUE: decoded block, NULL if it is malformed. Only valid until the next call,
+ *                 so callers keep interrupts off while they copy out of it
+ *   SIDE EFFECTS: updates the hit and miss counters
+ */
+uint8_t * blockcache_get (uint32_t inode, uint32_t index, const uint8_t * src, uint32_t src_len, uint32_t length) {
+	blockcache_t * entry;
+	blockcache_t * victim;
+	int i;
+
+	if (length == 0 || length > BLOCKCACHE_BLOCK_SIZE || src_len > length) {
+		return NULL;
+	}
+
+	blockcache_clock++;
+
+	victim = &(blockcache[0]);
+	for (i = 0; i < BLOCKCACHE_ENTRIES; i++) {
+		entry = &(blockcache[i]);
+		if (entry->length != 0 && entry->inode == inode && entry->index == index) {
+			entry->last_use = blockcache_clock;
+			blockcache_hits++;
+			return entry->data;
+		}
+
+		// prefer unused entries, then the oldest
+		if (victim->length != 0 && (entry->length == 0 || entry->last_use < victim->last_use)) {
+			victim = entry;
+		}
+	}
+
+	blockcache_misses++;
+
+	if (src_len == length) {
+		memcpy(victim->data, src, length);
+	} else if (lz_decode(src, src_len, victim->data, length) != length) {
+		victim->length = 0;
+		return NULL;
+	}
+
+	victim->inode = inode;
+	victim->index = index;
+	victim->length = length;
+	victim->last_use = blockcache_clock;
+
+	return victim->data;
+}
+
+/*
+ * blockcache_flush
+ *   DESCRIPTION: Empties the cache and resets its counters
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+void blockcache_flush (void) {
+	int i;
+
+	for (i = 0; i < BLOCKCACHE_ENTRIES; i++) {
+		blockcache[i].length = 0;
+	}
+
+	blockcache_hits = 0;
+	blockcache_misses = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef _BLOCKCACHE_H
+#define _BLOCKCACHE_H
+
+#include "types.h"
+
+#define BLOCKCACHE_ENTRIES 8 // decoded blocks kept at once
+#define BLOCKCACHE_BLOCK_SIZE 4096 // same as FS_BLOCK_SIZE
+
+// Decoded data block of a compressed file
+typedef struct blockcache_entry {
+	uint32_t inode; // inode of the file
+	uint32_t index; // which block, within the inode structure
+	uint32_t length; // number of decoded bytes, 0 if the entry is unused
+	uint32_t last_use; // blockcache_clock value at the last hit, for LRU eviction
+	uint8_t data[BLOCKCACHE_BLOCK_SIZE];
+} blockcache_t;
+
+// Counters for tuning BLOCKCACHE_ENTRIES
+extern uint32_t blockcache_hits;
+extern uint32_t blockcache_misses;
+
+extern int32_t lz_decode (const uint8_t * src, uint32_t src_len, uint8_t * dst, uint32_t dst_len);
+extern uint8_t * blockcache_get (uint32_t inode, uint32_t index, const uint8_t * src, uint32_t src_len, uint32_t length);
+extern void blockcache_flush (void);
+
+#endif
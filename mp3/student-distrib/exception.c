@@ -3,6 +3,8 @@
 #include "exception.h"
 #include "syscall.h"
 #include "types.h"
+#include "linkage.h"
+#include "signal.h"
 
 
 /*
@@ -40,7 +42,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_divide_by_zero) ; 
+        SET_IDT_ENTRY(eh_idt_desc, divide_by_zero_linker) ; 
         idt[0x00] = eh_idt_desc;
     }
     
@@ -104,7 +106,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_overflow) ; 
+        SET_IDT_ENTRY(eh_idt_desc, overflow_linker) ; 
         idt[0x04] = eh_idt_desc;
     }
     
@@ -120,7 +122,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_bound_range) ; 
+        SET_IDT_ENTRY(eh_idt_desc, bound_range_linker) ; 
         idt[0x05] = eh_idt_desc;
     }
     
@@ -136,7 +138,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_opcode) ; 
+        SET_IDT_ENTRY(eh_idt_desc, opcode_linker) ; 
         idt[0x06] = eh_idt_desc;
     }
     
@@ -232,7 +234,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_stack_segment_fault) ; 
+        SET_IDT_ENTRY(eh_idt_desc, stack_segment_fault_linker) ; 
         idt[0x0C] = eh_idt_desc;
     }
     
@@ -248,7 +250,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_protection_fault) ; 
+        SET_IDT_ENTRY(eh_idt_desc, protection_fault_linker) ; 
         idt[0x0D] = eh_idt_desc;
     }
     {
@@ -263,7 +265,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_page_fault) ; 
+        SET_IDT_ENTRY(eh_idt_desc, page_fault_linker) ; 
         idt[0x0E] = eh_idt_desc;
     }
     {
@@ -278,7 +280,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_x87_floating_point) ; 
+        SET_IDT_ENTRY(eh_idt_desc, x87_floating_point_linker) ; 
         idt[0x10] = eh_idt_desc;
     }
     {
@@ -293,7 +295,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_alignment_check) ; 
+        SET_IDT_ENTRY(eh_idt_desc, alignment_check_linker) ; 
         idt[0x11] = eh_idt_desc;
     }
     {
@@ -323,7 +325,7 @@ void init_exception_idt () {
         eh_idt_desc.dpl = 0;
         eh_idt_desc.present = 1;
         
-        SET_IDT_ENTRY(eh_idt_desc, eh_simd_floating_point) ; 
+        SET_IDT_ENTRY(eh_idt_desc, simd_floating_point_linker) ; 
         idt[0x13] = eh_idt_desc;
     }
     {
@@ -364,7 +366,7 @@ void eh_divide_by_zero () {
     cli();
     clear();
     printf("EXCEPTION 0x00: Divide by zero\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -373,7 +375,7 @@ void eh_debug () {
     cli();
     clear();
     printf("EXCEPTION 0x01: Debug\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -382,7 +384,7 @@ void eh_nmi () {
     cli();
     clear();
     printf("EXCEPTION 0x02: Non-maskable interrupt\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -392,7 +394,7 @@ void eh_breakpoint () {
     cli();
     clear();
     printf("EXCEPTION 0x03: Breakpoint\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -402,7 +404,7 @@ void eh_overflow () {
     cli();
     clear();
     printf("EXCEPTION 0x04: Overflow\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -412,7 +414,7 @@ void eh_bound_range () {
     cli();
     clear();
     printf("EXCEPTION 0x05: Bound range exceeded\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -422,7 +424,7 @@ void eh_opcode () {
     cli();
     clear();
     printf("EXCEPTION 0x06: Invalid opcode\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -432,7 +434,7 @@ void eh_device_not_available () {
     cli();
     clear();
     printf("EXCEPTION 0x07: Device not available\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
     
@@ -442,7 +444,7 @@ void eh_double_fault () {
     cli();
     clear();
     printf("EXCEPTION 0x08: Double fault\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -451,7 +453,7 @@ void eh_invalid_tss () {
     cli();
     clear();
     printf("EXCEPTION 0x0A: Invalid TSS\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -460,7 +462,7 @@ void eh_segment_not_present () {
     cli();
     clear();
     printf("EXCEPTION 0x0B: Segment not present\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -469,7 +471,7 @@ void eh_stack_segment_fault () {
     cli();
     clear();
     printf("EXCEPTION 0x0C: Stack segment fault\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -478,7 +480,7 @@ void eh_protection_fault () {
     cli();
     clear();
     printf("EXCEPTION 0x0D: General protection fault\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -487,7 +489,7 @@ void eh_page_fault () {
     cli();
     clear();
     printf("EXCEPTION 0x0E: Page fault\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -496,7 +498,7 @@ void eh_x87_floating_point () {
     cli();
     clear();
     printf("EXCEPTION 0x10: x87 Floating Point Exception\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -505,7 +507,7 @@ void eh_alignment_check () {
     cli();
     clear();
     printf("EXCEPTION 0x11: Alignment check\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -514,7 +516,7 @@ void eh_machine_check () {
     cli();
     clear();
     printf("EXCEPTION 0x12: Machine check\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -523,7 +525,7 @@ void eh_simd_floating_point () {
     cli();
     clear();
     printf("EXCEPTION 0x13: SIMD Floating Point Exception\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -532,7 +534,7 @@ void eh_virtualization () {
     cli();
     clear();
     printf("EXCEPTION 0x14: Virtualization Exception\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -541,7 +543,7 @@ void eh_security () {
     cli();
     clear();
     printf("EXCEPTION 0x1E: Security Exception\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
@@ -550,7 +552,7 @@ void eh_unused () {
     cli();
     clear();
     printf("EXCEPTION: Unused exception handler. Something went wrong.\n");
-	halt_syscall(0);
+	process_halt(HALT_EXCEPTION);
     sti();
     execute_syscall((uint8_t*)"shell");
 }
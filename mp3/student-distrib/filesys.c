@@ -3,22 +3,58 @@
 #include "terminal.h"
 #include "rtc.h"
 #include "pcb.h"
+#include "blockcache.h"
+#include "sysstat.h"
 
 // Addresses of the file system module
 static uint32_t module_start; 
 static uint32_t module_end; 
 static boot_block_t boot_block;
 
+// Entries of the directory, either boot_block.entries or the extended directory in the module
+static dentry_t * dir_entries;
+static uint32_t dir_count;
+
+// Name hash index over dir_entries, holds entry index + 1 (0 marks an empty slot)
+static uint32_t * dir_hash;
+static uint32_t dir_hash_size;
+
+// Index built at boot for images without an extended directory
+static uint32_t dentry_index[DENTRY_HASH_SIZE];
+
 // Operations table
-static operations_t file_operations[3] = {
+static operations_t file_operations[FILE_TYPES] = {
 	// type 0 is RTC
-	{.open_op = open_rtc, .read_op = read_rtc, .write_op = write_rtc, .close_op = close_rtc},
+	{.open_op = open_rtc, .read_op = read_rtc, .write_op = write_rtc, .close_op = close_rtc, .poll_op = poll_rtc},
 	// type 1 is directory
-	{.open_op = fdir_open, .read_op = fdir_read, .write_op = fdir_write, .close_op = fdir_close},
+	{.open_op = fdir_open, .read_op = fdir_read, .write_op = fdir_write, .close_op = fdir_close, .poll_op = fdir_poll},
 	// type 2 is file
-	{.open_op = file_open, .read_op = file_read, .write_op = file_write, .close_op = file_close}
+	{.open_op = file_open, .read_op = file_read, .write_op = file_write, .close_op = file_close, .poll_op = file_poll},
+	// type 3 is system call statistics
+	{.open_op = sysstat_open, .read_op = sysstat_read, .write_op = sysstat_write, .close_op = sysstat_close, .poll_op = sysstat_poll}
 };
 
+/*
+ * dentry_hash
+ *   Hashes a file name (FNV-1a) over at most max characters.
+ *   Inputs: fname - pointer to filename string
+ *			 max - maximum number of characters to hash
+ *			 len - written with the length of the name, capped at max
+ *   Outputs: hash of the name
+ */
+static uint32_t dentry_hash(const uint8_t* fname, uint32_t max, uint32_t* len) {
+	uint32_t hash = 2166136261U; // FNV offset basis
+	uint32_t i;
+	
+	for (i = 0; i < max && fname[i] != '\0'; i++) {
+		hash ^= fname[i];
+		hash *= 16777619; // FNV prime
+	}
+	
+	*len = i;
+	return hash;
+}
+
 /*
  * read_dentry_by_name
  *   Reads a directory entry based on filename.
@@ -27,9 +63,10 @@ static operations_t file_operations[3] = {
  *   Outputs: -1 on failure, 0 on success.
  */
 int32_t read_dentry_by_name(const uint8_t* fname, dentry_t* dentry) {
-	int i;
-	char desired[33];
-	char actual[33];
+	uint32_t slot;
+	uint32_t len;
+	uint32_t probes;
+	dentry_t * entry;
 	
 	if (dentry == NULL || fname == NULL) {
 		return -1;
@@ -39,20 +76,42 @@ int32_t read_dentry_by_name(const uint8_t* fname, dentry_t* dentry) {
 		return -1;
 	}
 	
-	for (i = 0; i < DENTRY_COUNT; i++) {
-		memcpy (desired, fname, FNAME_MAX_LEN + 1);
-		memcpy (actual, boot_block.entries[i].file_name, FNAME_MAX_LEN);
-		actual[32] = '\0';
+	slot = dentry_hash(fname, FNAME_MAX_LEN + 1, &len) & (dir_hash_size - 1);
+	
+	// names longer than 32 characters can never match
+	if (len > FNAME_MAX_LEN) {
+		return -1;
+	}
+	
+	// linear probe until an empty slot, at most once around the table
+	for (probes = 0; probes < dir_hash_size && dir_hash[slot] != 0; probes++) {
+		if (dir_hash[slot] > dir_count) { // corrupt slot
+			return -1;
+		}
+		entry = &(dir_entries[dir_hash[slot] - 1]);
 		
-		if (strncmp(actual, desired, FNAME_MAX_LEN + 1) == 0) { // if all 32 characters + terminator match
-			memcpy(dentry, &(boot_block.entries[i]), sizeof(dentry_t));
+		// stored names are only terminated when shorter than 32 characters
+		if (strncmp(entry->file_name, (int8_t*) fname, len) == 0 && (len == FNAME_MAX_LEN || entry->file_name[len] == '\0')) {
+			memcpy(dentry, entry, sizeof(dentry_t));
 			return 0;
 		}
+		
+		slot = (slot + 1) & (dir_hash_size - 1);
 	}
 	
 	return -1;
 }
 
+/*
+ * filesys_boot_block
+ *   Gives the lookup benchmark the boot block, to time the original linear scan over it.
+ *   Inputs: none
+ *   Outputs: the copy of the boot block read at init
+ */
+const boot_block_t * filesys_boot_block() {
+	return &boot_block;
+}
+
 /*
  * read_dentry_by_index
  *   Reads a directory entry based on index.
@@ -61,15 +120,189 @@ int32_t read_dentry_by_name(const uint8_t* fname, dentry_t* dentry) {
  *   Outputs: -1 on failure, 0 on success.
  */
 int32_t read_dentry_by_index(uint32_t index, dentry_t* dentry) {
-	if (index < 0 || index >= DENTRY_COUNT || dentry == NULL) {
+	if (index >= dir_count || dentry == NULL) {
 		return -1;
 	}
 	
 	// copy into dentry
-	memcpy(dentry, &(boot_block.entries[index]), sizeof(dentry_t));
+	memcpy(dentry, &(dir_entries[index]), sizeof(dentry_t));
 	return 0;
 }
 
+/*
+ * inode_addr
+ *   Gets the address of an inode in the file system module
+ *   Inputs: inode index
+ *   Outputs: NULL on failure, otherwise pointer to the inode
+ */
+static inode_t * inode_addr(uint32_t inode) {
+	if (inode >= boot_block.num_inodes) {
+		return NULL;
+	}
+	
+	return (inode_t *) (module_start + FS_BLOCK_SIZE * (inode + 1));
+}
+
+/*
+ * block_addr
+ *   Gets the address of a data block in the file system module
+ *   Inputs: block - data block number
+ *   Outputs: NULL on failure, otherwise pointer to the data block
+ */
+static uint8_t * block_addr(uint32_t block) {
+	if (block >= boot_block.num_datablocks) {
+		return NULL;
+	}
+	
+	return (uint8_t *) (module_start + FS_BLOCK_SIZE * (block + boot_block.num_inodes + 1));
+}
+
+/*
+ * node_length
+ *   Gets the length of a file without the compression flag
+ *   Inputs: node - inode of the file
+ *   Outputs: the file length in bytes
+ */
+static uint32_t node_length(inode_t* node) {
+	return node->length & INODE_LENGTH_MASK;
+}
+
+/*
+ * compressed_block
+ *   Gets a decoded data block of a compressed file through the block cache
+ *   Inputs: inode - inode index of the file
+ *			 node - inode of the file
+ *			 block_index - which block, within the inode structure
+ *   Outputs: NULL on failure, otherwise pointer to the decoded block. Only valid until the
+ *            next block cache lookup
+ */
+static uint8_t * compressed_block(uint32_t inode, inode_t* node, uint32_t block_index) {
+	uint32_t start; // byte offset of the encoded block
+	uint32_t end; // byte offset just past the encoded block
+	uint32_t length; // decoded length
+	
+	if (block_index + 1 >= INODE_BLOCKS) {
+		return NULL;
+	}
+	
+	start = node->data_blocks[block_index];
+	end = node->data_blocks[block_index + 1];
+	if (end < start || end > boot_block.num_datablocks * FS_BLOCK_SIZE) {
+		return NULL;
+	}
+	
+	length = node_length(node) - block_index * FS_BLOCK_SIZE;
+	if (length > FS_BLOCK_SIZE) {
+		length = FS_BLOCK_SIZE;
+	}
+	
+	return blockcache_get(inode, block_index, (uint8_t *) (module_start + FS_BLOCK_SIZE * (boot_block.num_inodes + 1) + start), end - start, length);
+}
+
+/*
+ * copy_compressed
+ *   Copies bytes of a compressed file into a buffer, one decoded block at a time
+ *   Inputs: inode - inode index of the file
+ *			 node - inode of the file
+ *			 block_index - which block, within the inode structure, to start at
+ *			 data_offset - offset of the first byte within that block
+ *		     buf - buffer to write data to
+ *           length - number of bytes to copy, must not go past EOF
+ *   Outputs: -1 on failure, returns the number of bytes copied
+ */
+static int32_t copy_compressed(uint32_t inode, inode_t* node, uint32_t block_index, uint32_t data_offset, uint8_t* buf, uint32_t length) {
+	uint32_t copied; // bytes that have been copied
+	uint32_t chunk; // bytes copied from the block
+	uint8_t* addr; // decoded block
+	uint32_t flags;
+	
+	copied = 0;
+	while (copied < length) {
+		chunk = FS_BLOCK_SIZE - data_offset;
+		if (chunk > length - copied) {
+			chunk = length - copied;
+		}
+		
+		// the cache entry can be evicted by whoever runs next, so copy it out before then
+		cli_and_save(flags);
+		addr = compressed_block(inode, node, block_index);
+		if (addr != NULL) {
+			memcpy(buf + copied, addr + data_offset, chunk);
+		}
+		restore_flags(flags);
+		
+		if (addr == NULL) {
+			return -1;
+		}
+		
+		copied += chunk;
+		block_index++;
+		data_offset = 0;
+	}
+	
+	return copied;
+}
+
+/*
+ * copy_data
+ *   Copies bytes of a file into a buffer, one memcpy per run of physically consecutive blocks
+ *   Inputs: inode - inode index of the file
+ *			 node - inode of the file
+ *			 block_index - which block, within the inode structure, to start at
+ *			 data_offset - offset of the first byte within that block
+ *		     buf - buffer to write data to
+ *           length - number of bytes to copy, must not go past EOF
+ *   Outputs: -1 on failure, returns the number of bytes copied
+ */
+static int32_t copy_data(uint32_t inode, inode_t* node, uint32_t block_index, uint32_t data_offset, uint8_t* buf, uint32_t length) {
+	uint32_t copied; // bytes that have been copied
+	uint32_t block; // first data block number of the run
+	uint32_t run; // number of blocks in the run
+	uint32_t chunk; // bytes copied from the run
+	uint8_t* addr; // memory location of actual data
+	
+	if (node->length & INODE_COMPRESSED) {
+		return copy_compressed(inode, node, block_index, data_offset, buf, length);
+	}
+	
+	copied = 0;
+	while (copied < length) {
+		// length runs past the inode's block list
+		if (block_index >= INODE_BLOCKS) {
+			return -1;
+		}
+		
+		block = node->data_blocks[block_index];
+		addr = block_addr(block);
+		
+		// bad block index
+		if (addr == NULL) {
+			return -1;
+		}
+		
+		// extend the run while the next block directly follows this one in the module
+		run = 1;
+		chunk = FS_BLOCK_SIZE - data_offset;
+		while (chunk < length - copied && block_index + run < INODE_BLOCKS
+				&& node->data_blocks[block_index + run] == block + run
+				&& block + run < boot_block.num_datablocks) {
+			chunk += FS_BLOCK_SIZE;
+			run++;
+		}
+		
+		if (chunk > length - copied) { // run holds more than we need
+			chunk = length - copied;
+		}
+		
+		memcpy(buf + copied, addr + data_offset, chunk);
+		copied += chunk;
+		block_index += run;
+		data_offset = 0;
+	}
+	
+	return copied;
+}
+
 /*
  * read_data
  *   Reads data from file system based on inode and offset
@@ -80,71 +313,163 @@ int32_t read_dentry_by_index(uint32_t index, dentry_t* dentry) {
  *   Outputs: -1 on failure, returns the number of bytes read
  */
 int32_t read_data(uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t length) {
-	unsigned int block_index; // which block, within the inode structure, we are accessing
-	unsigned int data_offset; // offset of the data within the block
-	unsigned int copied; // bytes that have been copied
-	unsigned int memory_index; // memory location of actual data
 	inode_t* node; // inode containing file information
 	
+	node = inode_addr(inode); // get address of inode
+	
 	// Check inode bounds and arguments
-	if (inode < 0 || inode >= boot_block.num_inodes || buf == NULL) {
+	if (node == NULL || buf == NULL) {
 		return -1;
 	}
 	
-	node = (inode_t *) (module_start + FS_BLOCK_SIZE * (inode + 1)); // get address of inode
+	if (offset > node_length(node)) { // offset is outside file
+		return -1;
+	}
+	
+	if (length > node_length(node) - offset) {  // if desired bytes go past EOF
+		length = node_length(node) - offset; // truncate desired bytes to end of file
+	}
 	
-	if (offset >= node->length + 1) { // offset is outside file
+	return copy_data(inode, node, offset / FS_BLOCK_SIZE, offset % FS_BLOCK_SIZE, buf, length);
+}
+
+/*
+ * inode_length
+ *   Gets the length of a file
+ *   Inputs: inode index of the file
+ *   Outputs: -1 on failure, otherwise the file length in bytes
+ */
+int32_t inode_length(uint32_t inode) {
+	inode_t* node = inode_addr(inode);
+	
+	if (node == NULL) {
 		return -1;
 	}
 	
-	copied = 0;
-	block_index = offset / FS_BLOCK_SIZE;
-	data_offset = offset % FS_BLOCK_SIZE;
-	memory_index = ((node->data_blocks[block_index] + boot_block.num_inodes + 1) * FS_BLOCK_SIZE);
+	return node_length(node);
+}
+
+/*
+ * inode_block
+ *   Gets the address of one of a file's data blocks inside the file system module
+ *   Inputs: inode index of the file
+ *			 index - which block, within the inode structure
+ *   Outputs: NULL on failure or if the file is compressed, otherwise pointer to the data block
+ */
+uint8_t* inode_block(uint32_t inode, uint32_t index) {
+	inode_t* node = inode_addr(inode);
 	
-	if (length + offset > node->length) {  // if desired bytes go past EOF
-		length = node->length - offset; // truncate desired bytes to end of file
+	if (node == NULL || (node->length & INODE_COMPRESSED) || index >= INODE_BLOCKS
+			|| index >= (node_length(node) + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE) {
+		return NULL;
 	}
 	
-	// if we start off in the middle of a block
-	if (data_offset > 0) {
-		// bad block index
-		if (node->data_blocks[block_index] >= boot_block.num_datablocks) {
+	return block_addr(node->data_blocks[index]);
+}
+
+/*
+ * read_cursor
+ *   Sequential read of an open file through its cached read cursor. Reads that stay inside
+ *   the cached block are a single memcpy; others fall back to copy_data and re-cache the
+ *   block holding the new file position.
+ *   Inputs: file - file array entry of an open normal file
+ *		     buf - buffer to write data to
+ *           length - number of bytes to read
+ *   Outputs: -1 on failure, returns the number of bytes read
+ */
+static int32_t read_cursor(farray_t* file, uint8_t* buf, uint32_t length) {
+	uint32_t data_offset;
+	int32_t read;
+	
+	if (file->inode == NULL) {
+		file->inode = inode_addr(file->inode_num);
+		file->block_addr = NULL;
+		if (file->inode == NULL) {
 			return -1;
 		}
-		
-		if (FS_BLOCK_SIZE - data_offset >= length) { // if we can copy everything from 1 block
-			memcpy(buf, (void *)(memory_index + data_offset + module_start), length); 
-			return length;
-		} else { // pull from the rest of this block
-			memcpy(buf, (void *)(memory_index + data_offset + module_start), FS_BLOCK_SIZE - data_offset); // copy the bytes until we're aligned
-			block_index++; // go to start of next block
-			copied = FS_BLOCK_SIZE - data_offset;
-			data_offset = 0;
-		}
 	}
 	
-	// copy the rest of the data block by block
-	while (copied < length) {
-		memory_index = ((node->data_blocks[block_index] + boot_block.num_inodes + 1) * FS_BLOCK_SIZE);
-
-		// bad block index
-		if (node->data_blocks[block_index] >= boot_block.num_datablocks) {
+	if (file->file_pos > node_length(file->inode)) { // offset is outside file
+		return -1;
+	}
+	
+	if (length > node_length(file->inode) - file->file_pos) { // if desired bytes go past EOF
+		length = node_length(file->inode) - file->file_pos;
+	}
+	
+	data_offset = file->file_pos % FS_BLOCK_SIZE;
+	
+	// fast path: everything comes from the cached block
+	if (file->block_addr != NULL && file->block_index == file->file_pos / FS_BLOCK_SIZE
+			&& length <= FS_BLOCK_SIZE - data_offset) {
+		memcpy(buf, file->block_addr + data_offset, length);
+		read = length;
+	} else {
+		read = copy_data(file->inode_num, file->inode, file->file_pos / FS_BLOCK_SIZE, data_offset, buf, length);
+		if (read == -1) {
 			return -1;
 		}
-		
-		if (length - copied > FS_BLOCK_SIZE) { // if remaining bytes more than 1 block
-			memcpy(buf + copied, (void *)(memory_index + module_start), FS_BLOCK_SIZE); // copy one block of data
-			block_index++;
-		}  else { // remaining bytes get copied
-			memcpy(buf + copied, (void *)(memory_index + module_start), length - copied);
-			return length;
+	}
+	
+	file->file_pos += read;
+	
+	// cache the block holding the next byte to read, compressed blocks live in the block cache instead
+	if (file->block_addr == NULL || file->block_index != file->file_pos / FS_BLOCK_SIZE) {
+		file->block_addr = NULL;
+		if (file->file_pos < node_length(file->inode) && file->file_pos / FS_BLOCK_SIZE < INODE_BLOCKS
+				&& !(file->inode->length & INODE_COMPRESSED)) {
+			file->block_index = file->file_pos / FS_BLOCK_SIZE;
+			file->block_addr = block_addr(file->inode->data_blocks[file->block_index]);
 		}
-		
-		copied += FS_BLOCK_SIZE;
 	}
 	
-	return copied;
+	return read;
+}
+
+/*
+ * extended_dir_init
+ *   Finds the extended directory described by the boot block, if the image has one
+ *   Inputs: none
+ *   Outputs: 1 if dir_entries and dir_hash now point into the module, 0 otherwise
+ */
+static int extended_dir_init(void) {
+	uint32_t start; // first block of the directory
+	uint32_t hash_blocks; // blocks holding the hash table
+	
+	if (boot_block.dir_magic != DIR_MAGIC) {
+		return 0;
+	}
+	
+	// keep the sizes below from overflowing
+	if (boot_block.dir_hash_size > (module_end - module_start) / sizeof(uint32_t)
+			|| boot_block.dir_blocks > (module_end - module_start) / FS_BLOCK_SIZE
+			|| boot_block.num_inodes + boot_block.num_datablocks > (module_end - module_start) / FS_BLOCK_SIZE) {
+		return 0;
+	}
+	
+	// hash table must be a power of two with at least one empty slot
+	if (boot_block.dir_hash_size == 0 || (boot_block.dir_hash_size & (boot_block.dir_hash_size - 1)) != 0
+			|| boot_block.dir_hash_size <= boot_block.dir_entries) {
+		return 0;
+	}
+	
+	if (boot_block.dir_blocks < (boot_block.dir_entries * sizeof(dentry_t) + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE) {
+		return 0;
+	}
+	
+	// everything has to be inside the module
+	start = 1 + boot_block.num_inodes + boot_block.num_datablocks;
+	hash_blocks = (boot_block.dir_hash_size * sizeof(uint32_t) + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE;
+	if ((start + boot_block.dir_blocks + hash_blocks) * FS_BLOCK_SIZE > module_end - module_start) {
+		return 0;
+	}
+	
+	dir_entries = (dentry_t *) (module_start + FS_BLOCK_SIZE * start);
+	dir_count = boot_block.dir_entries;
+	dir_hash = (uint32_t *) (module_start + FS_BLOCK_SIZE * (start + boot_block.dir_blocks));
+	dir_hash_size = boot_block.dir_hash_size;
+	
+	return 1;
 }
 
 /*
@@ -153,7 +478,11 @@ int32_t read_data(uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t length
  *   Inputs: module_ptr - Pointer to the file system module installed at boot.
  *   Outputs: none
  */
-void filesys_init (module_t * module_ptr) {	
+void filesys_init (module_t * module_ptr) {
+	uint32_t i;
+	uint32_t slot;
+	uint32_t len;
+	
 	if (module_ptr == NULL) {
 	    return;
 	}
@@ -164,6 +493,35 @@ void filesys_init (module_t * module_ptr) {
 	// pull boot block info
 	memcpy((void *) (&boot_block), (void *) module_start, sizeof(boot_block_t));
 	
+	if (boot_block.num_entries > DENTRY_COUNT) {
+		boot_block.num_entries = DENTRY_COUNT;
+	}
+	
+	// drop blocks decoded from any earlier module
+	blockcache_flush();
+	
+	// use the extended directory and its hash table as they are in the module
+	if (extended_dir_init()) {
+		return;
+	}
+	
+	dir_entries = boot_block.entries;
+	dir_count = boot_block.num_entries;
+	dir_hash = dentry_index;
+	dir_hash_size = DENTRY_HASH_SIZE;
+	
+	// build name hash index
+	memset(dentry_index, 0, sizeof(dentry_index));
+	for (i = 0; i < boot_block.num_entries; i++) {
+		slot = dentry_hash((uint8_t*) boot_block.entries[i].file_name, FNAME_MAX_LEN, &len) & (DENTRY_HASH_SIZE - 1);
+		
+		while (dentry_index[slot] != 0) {
+			slot = (slot + 1) & (DENTRY_HASH_SIZE - 1);
+		}
+		
+		dentry_index[slot] = i + 1;
+	}
+	
 	return;
 }
 
@@ -197,6 +555,16 @@ int fdir_write (uint32_t fd, const void * buf, uint32_t nbytes) {
 	return -1;
 }
 
+/*
+ * fdir_poll
+ *   Directory reads never wait.
+ *   Inputs: fd - ignored
+ *   Outputs: Returns POLLIN | POLLOUT
+ */
+int fdir_poll (uint32_t fd) {
+	return POLLIN | POLLOUT;
+}
+
 
 /*
  * fdir_read
@@ -209,7 +577,7 @@ int fdir_write (uint32_t fd, const void * buf, uint32_t nbytes) {
  */
 int fdir_read (uint32_t fd, void * buf, uint32_t nbytes) {
 	int i;
-	int8_t string_to_send[nbytes + FNAME_MAX_LEN + 1]; // buffer with sufficient space
+	int8_t string_to_send[FNAME_MAX_LEN + 1]; // buffer with sufficient space
 	pcb_t * pcb;
 	int len;
 	
@@ -226,23 +594,27 @@ int fdir_read (uint32_t fd, void * buf, uint32_t nbytes) {
 	}
 
 	// if nothing to read
-	if (pcb->file_array[fd].file_pos >= boot_block.num_entries) {
+	if (pcb->file_array[fd].file_pos >= dir_count) {
 		return 0;
 	}
 	
 	i = pcb->file_array[fd].file_pos;
 
-	strncpy(string_to_send, boot_block.entries[i].file_name, FNAME_MAX_LEN); // copy filename
+	strncpy(string_to_send, dir_entries[i].file_name, FNAME_MAX_LEN); // copy filename
 		
 	// move offset
-	if (strlen(boot_block.entries[i].file_name) < FNAME_MAX_LEN) {
-		len = strlen(boot_block.entries[i].file_name);  
+	if (strlen(dir_entries[i].file_name) < FNAME_MAX_LEN) {
+		len = strlen(dir_entries[i].file_name);  
 	} else {
 		len = FNAME_MAX_LEN;
 	}
 	
 	string_to_send[len] = '\0';
 
+	// never write past the nbytes the caller checked
+	if (len > nbytes) {
+		len = nbytes;
+	}
 	memcpy(buf, (void* ) string_to_send, len);
 
 	pcb->file_array[fd].file_pos++;
@@ -250,6 +622,137 @@ int fdir_read (uint32_t fd, void * buf, uint32_t nbytes) {
 	return len;
 }
 
+/*
+ * fdir_getdents
+ *   Reads as many directory entries as fit in the buffer, as fixed-size dirent_t records
+ *   Inputs: fd - file descriptor of an open directory
+ *			buf - buffer to read into
+ *			nbytes - size of the buffer
+ *   Outputs: -1 on failure, otherwise number of bytes written, 0 once every entry has been read
+ */
+int fdir_getdents (uint32_t fd, void * buf, uint32_t nbytes) {
+	dirent_t * record;
+	dentry_t * entry;
+	pcb_t * pcb;
+	uint32_t count;
+	
+	pcb = get_pcb();
+	
+	// check file descriptor and buffer
+	if (fd >= FARRAY_SIZE || buf == NULL) {
+		return -1;
+	}
+	
+	// if no directory opened
+	if (pcb->file_array[fd].flags == 0 || pcb->file_array[fd].operations_pointer != &(file_operations[1])) {
+		return -1;
+	}
+	
+	record = (dirent_t *) buf;
+	count = 0;
+	while (count < nbytes / sizeof(dirent_t) && pcb->file_array[fd].file_pos < dir_count) {
+		entry = &(dir_entries[pcb->file_array[fd].file_pos]);
+		
+		memcpy(record[count].file_name, entry->file_name, FNAME_MAX_LEN);
+		record[count].file_type = entry->file_type;
+		if (entry->file_type == 2) { // normal file
+			record[count].inode_num = entry->inode_num;
+			record[count].length = inode_length(entry->inode_num);
+		} else {
+			record[count].inode_num = 0;
+			record[count].length = 0;
+		}
+		
+		count++;
+		pcb->file_array[fd].file_pos++;
+	}
+	
+	return count * sizeof(dirent_t);
+}
+
+/*
+ * fill_stat
+ *   Fills in file information for a type and inode
+ *   Inputs: file_type - type of the file
+ *			inode - inode of the file, ignored unless type 2
+ *			st - stat struct to write to
+ *   Outputs: -1 on failure, 0 on success
+ */
+static int fill_stat (uint32_t file_type, uint32_t inode, stat_t * st) {
+	int32_t length;
+	
+	st->file_type = file_type;
+	st->inode_num = 0;
+	st->length = 0;
+	st->blocks = 0;
+	
+	if (file_type == 2) { // normal file
+		length = inode_length(inode);
+		if (length == -1) {
+			return -1;
+		}
+		st->inode_num = inode;
+		st->length = length;
+		st->blocks = (length + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE;
+	}
+	
+	return 0;
+}
+
+/*
+ * file_stat
+ *   Gets information on a file given its name
+ *   Inputs: filename - string containing a file's name
+ *			st - stat struct to write to
+ *   Outputs: -1 on failure, 0 on success
+ */
+int file_stat (const uint8_t * filename, stat_t * st) {
+	dentry_t file_dentry;
+	
+	if (filename == NULL || st == NULL) {
+		return -1;
+	}
+	
+	if (-1 == read_dentry_by_name(filename, &file_dentry)) {
+		return -1;
+	}
+	
+	return fill_stat(file_dentry.file_type, file_dentry.inode_num, st);
+}
+
+/*
+ * file_fstat
+ *   Gets information on an open file given its descriptor
+ *   Inputs: fd - file descriptor of a file opened from the file system
+ *			st - stat struct to write to
+ *   Outputs: -1 on failure (including stdin/stdout), 0 on success
+ */
+int file_fstat (uint32_t fd, stat_t * st) {
+	uint32_t file_type;
+	pcb_t * pcb;
+	
+	pcb = get_pcb();
+	
+	// check file descriptor and buffer
+	if (fd >= FARRAY_SIZE || st == NULL) {
+		return -1;
+	}
+	
+	// if no file opened
+	if (pcb->file_array[fd].flags == 0) {
+		return -1;
+	}
+	
+	// the type is the file's index in the operations table
+	for (file_type = 0; file_type < FILE_TYPES; file_type++) {
+		if (pcb->file_array[fd].operations_pointer == &(file_operations[file_type])) {
+			return fill_stat(file_type, pcb->file_array[fd].inode_num, st);
+		}
+	}
+	
+	return -1;
+}
+
 /*
  * file_open
  *   Opens a file in the file system given a file name
@@ -283,15 +786,25 @@ int file_open (const uint8_t * filename) {
 		return -1;
 	}
 	
+	// unknown type in the image
+	if (file_dentry.file_type >= FILE_TYPES) {
+		return -1;
+	}
+	
 	pcb->file_array[i].operations_pointer = (operations_t *) (&(file_operations[file_dentry.file_type])); // set up operations table
 	
 	if (file_dentry.file_type == 2) { // entry is a normal file, type 2
 		pcb->file_array[i].inode_num = file_dentry.inode_num;
-	} else { // entry is directory or rtc
+	} else { // entry is directory, rtc or sysstat
 		pcb->file_array[i].inode_num = 0;
 		pcb->file_array[i].operations_pointer->open_op(filename);
 	}
 	
+	// reset read cursor
+	pcb->file_array[i].inode = NULL;
+	pcb->file_array[i].block_index = 0;
+	pcb->file_array[i].block_addr = NULL;
+	
 	pcb->file_array[i].flags |= 0x1; // mark as in use
 	
 	return i;
@@ -322,15 +835,112 @@ int file_read (uint32_t fd, void * buf, uint32_t num) {
 		return -1;
 	}
 	
-	read = read_data(pcb->file_array[fd].inode_num, pcb->file_array[fd].file_pos, (uint8_t*) buf, num);
-	if (read == -1) {
+	// read through the cursor, which moves the file position
+	read = read_cursor(&(pcb->file_array[fd]), (uint8_t*) buf, num);
+	
+	return read;
+}
+
+/*
+ * regular_file
+ *   Gets the file array entry of an open regular file
+ *   Inputs: fd - file descriptor/index in file array
+ *   Outputs: NULL if fd is not an open regular file, otherwise its entry
+ */
+static farray_t * regular_file (uint32_t fd) {
+	pcb_t * pcb;
+	
+	pcb = get_pcb();
+	
+	if (fd >= FARRAY_SIZE || pcb->file_array[fd].flags == 0) {
+		return NULL;
+	}
+	
+	if (pcb->file_array[fd].operations_pointer != &(file_operations[2])) {
+		return NULL;
+	}
+	
+	return &(pcb->file_array[fd]);
+}
+
+/*
+ * file_lseek
+ *   Moves the position of an open regular file
+ *   Inputs: fd - file descriptor/index in file array
+ *           offset - signed byte offset
+ *           whence - SEEK_SET, SEEK_CUR or SEEK_END
+ *   Outputs: Returns -1 on failure. Otherwise returns the new position.
+ *   Side effects: Later file_reads start at the new position
+ */
+int file_lseek (uint32_t fd, int32_t offset, uint32_t whence) {
+	farray_t * file;
+	int32_t length;
+	int32_t pos;
+	
+	file = regular_file(fd);
+	if (file == NULL) {
 		return -1;
 	}
 	
-	// move file position
-	pcb->file_array[fd].file_pos += read;
+	length = inode_length(file->inode_num);
+	if (length == -1) {
+		return -1;
+	}
 	
-	return read;
+	switch (whence) {
+		case SEEK_SET:
+			pos = offset;
+			break;
+		case SEEK_CUR:
+			pos = file->file_pos + offset;
+			break;
+		case SEEK_END:
+			pos = length + offset;
+			break;
+		default:
+			return -1;
+	}
+	
+	// files are read only, so there is nothing past EOF to seek to
+	if (pos < 0 || pos > length) {
+		return -1;
+	}
+	
+	// the cached block is keyed by index, so read_cursor drops it if it no longer matches
+	file->file_pos = pos;
+	
+	return pos;
+}
+
+/*
+ * file_pread
+ *   Reads data from a given offset of a file without moving its position
+ *   Inputs: fd - file descriptor/index in file array
+ *           buf - pointer to buffer to write to
+ *           num - number of bytes to read
+ *           offset - byte offset in the file to start at
+ *   Outputs: Returns -1 on failure, 0 at or past EOF. Otherwise returns the number of bytes read.
+ *   Side effects: Writes to buf
+ */
+int file_pread (uint32_t fd, void * buf, uint32_t num, uint32_t offset) {
+	farray_t * file;
+	int32_t length;
+	
+	file = regular_file(fd);
+	if (file == NULL || buf == NULL) {
+		return -1;
+	}
+	
+	length = inode_length(file->inode_num);
+	if (length == -1) {
+		return -1;
+	}
+	
+	if (offset >= length) {
+		return 0;
+	}
+	
+	return read_data(file->inode_num, offset, (uint8_t*) buf, num);
 }
 
 /*
@@ -355,6 +965,16 @@ int file_write (uint32_t fd, const void * buf, uint32_t nbytes) {
 	return -1;
 }
 
+/*
+ * file_poll
+ *   File reads never wait.
+ *   Inputs: fd - ignored
+ *   Outputs: Returns POLLIN | POLLOUT
+ */
+int file_poll (uint32_t fd) {
+	return POLLIN | POLLOUT;
+}
+
 /*
  * program_imgcpy
  *   Copy program image into a contiguious section of memory.
@@ -8,6 +8,15 @@
 #define DENTRY_COUNT 63
 #define FS_BLOCK_SIZE 4096
 #define FNAME_MAX_LEN 32
+#define DENTRY_HASH_SIZE 128 // power of two, at least twice DENTRY_COUNT
+#define DIR_MAGIC 0x52494458 // "XDIR", the boot block describes an extended directory
+#define INODE_BLOCKS 1023 // data block entries in an inode
+#define INODE_COMPRESSED 0x80000000 // inode length flag, data blocks are LZ compressed
+#define INODE_LENGTH_MASK 0x7FFFFFFF
+#define SEEK_SET 0 // file_lseek: offset from the start of the file
+#define SEEK_CUR 1 // file_lseek: offset from the current position
+#define SEEK_END 2 // file_lseek: offset from the end of the file
+#define FILE_TYPES 4 // dentry types: 0 RTC, 1 directory, 2 file, 3 system call statistics
 
 // Type for a file directory entry
 typedef struct directory_entry {
@@ -17,44 +26,97 @@ typedef struct directory_entry {
 	uint8_t reserved[24]; // 24 reserved bytes
 } dentry_t;
 
+// With dir_magic set to DIR_MAGIC, the directory is instead dir_entries dentries packed into
+// dir_blocks blocks right after the data blocks, followed by a hash table of dir_hash_size
+// 32-bit slots. Each slot holds entry index + 1 (0 marks an empty slot), placed by linear
+// probing from the FNV-1a hash of the name. entries[] keeps the first 63 for older kernels
 typedef struct boot_struct {
 	uint32_t num_entries;
 	uint32_t num_inodes;
 	uint32_t num_datablocks; // number of data blocks in whole system
-	uint8_t reserved[52]; // 52 reserved byte
+	uint32_t dir_magic; // DIR_MAGIC if there is an extended directory
+	uint32_t dir_entries; // number of entries in the extended directory
+	uint32_t dir_blocks; // number of blocks holding them
+	uint32_t dir_hash_size; // number of hash table slots, a power of two above dir_entries
+	uint8_t reserved[36]; // 36 reserved byte
 	dentry_t entries[DENTRY_COUNT];
 } boot_block_t;
 
+// With INODE_COMPRESSED set in length, data_blocks[i] is instead the byte offset of encoded
+// block i from the start of the data blocks, and data_blocks[i + 1] marks where it ends
 typedef struct inode_struct {
 	uint32_t length;
-	uint32_t data_blocks[1023]; // data block numbers, up to 1023 blocks
+	uint32_t data_blocks[INODE_BLOCKS]; // data block numbers, up to 1023 blocks
 } inode_t;
 
+// Fixed-size record filled in by fdir_getdents, one per directory entry
+typedef struct dir_record {
+	char file_name[FNAME_MAX_LEN]; // Not terminated when 32 characters long
+	uint32_t file_type; // Type of file, same as dentry_t
+	uint32_t inode_num; // Index node number, 0 for types 0 and 1
+	uint32_t length; // File length in bytes, 0 for types 0 and 1
+} dirent_t;
+
+// File information returned by file_stat and file_fstat
+typedef struct file_stat {
+	uint32_t file_type; // Type of file, same as dentry_t
+	uint32_t inode_num; // Index node number, 0 for types 0 and 1
+	uint32_t length; // File length in bytes, 0 for types 0 and 1
+	uint32_t blocks; // Number of data blocks, 0 for types 0 and 1
+} stat_t;
+
+// Readiness bits returned by poll_op
+#define POLLIN	0x1 // a read would not wait
+#define POLLOUT	0x4 // a write would not wait
+
 typedef struct operations_table_entry {
 	int32_t (*open_op)(const uint8_t*);
 	int32_t (*read_op)(uint32_t, void*, uint32_t);
 	int32_t (*write_op)(uint32_t, const void*, uint32_t);
 	int32_t (*close_op)(uint32_t);
+	int32_t (*poll_op)(uint32_t); // returns POLLIN/POLLOUT bits without waiting
+	int32_t (*dup_op)(uint32_t); // counts another copy of the open file, NULL if nothing to count
 } operations_t;
 
+// Bits of farray_t flags
+#define FD_IN_USE	0x1 // entry holds an open file
+#define FD_CLOEXEC	0x2 // not inherited by programs started by execute or spawn
+
+struct pipe;
+
 typedef struct file_array_entry {
     operations_t* operations_pointer; // pointer to correct operations jump table for file type
 	uint32_t inode_num; // Should be 0 for directory and RTC file
 	uint32_t file_pos; // Tracks current position of user in file
 	uint32_t flags; // Multiple uses, marks entry as in use
+	inode_t* inode; // Read cursor: cached inode of a normal file, NULL until first read
+	uint32_t block_index; // Read cursor: index into inode->data_blocks of the cached block
+	uint8_t* block_addr; // Read cursor: module address of the cached block, NULL if not cached
+	struct pipe* pipe; // Pipe of a pipe end, NULL otherwise
 } farray_t;
 
 extern void filesys_init (module_t *);
 extern int32_t read_dentry_by_name(const uint8_t*, dentry_t*);
+extern int32_t read_dentry_by_index(uint32_t, dentry_t*);
+extern const boot_block_t * filesys_boot_block();
 extern int32_t read_data(uint32_t, uint32_t, uint8_t*, uint32_t);
+extern int32_t inode_length(uint32_t);
+extern uint8_t* inode_block(uint32_t, uint32_t);
 extern int fdir_open(const uint8_t* filename);
 extern int fdir_close(uint32_t fd);
 extern int fdir_write(uint32_t, const void *, uint32_t);
+extern int fdir_poll(uint32_t);
 extern int fdir_read(uint32_t, void *, uint32_t);
+extern int fdir_getdents(uint32_t, void *, uint32_t);
+extern int file_stat(const uint8_t *, stat_t *);
+extern int file_fstat(uint32_t, stat_t *);
+extern int file_lseek(uint32_t, int32_t, uint32_t);
+extern int file_pread(uint32_t, void *, uint32_t, uint32_t);
 extern int file_open(const uint8_t *);
 extern int file_close(uint32_t);
 extern int file_read(uint32_t, void *, uint32_t);
 extern int file_write(uint32_t, const void *, uint32_t);
+extern int file_poll(uint32_t);
 extern int program_imgcpy(uint8_t *, void *);
 
 #endif
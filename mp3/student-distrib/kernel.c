@@ -20,6 +20,7 @@
 #include "scheduling.h"
 
 #define RUN_TESTS 1
+// #define RUN_BENCHMARKS 1 // print the benchmarks in place of starting the shell
 
 /* Macros. */
 
@@ -113,6 +114,31 @@ void entry(unsigned long magic, unsigned long addr) {
                     (unsigned)mmap->length_low);
     }
 
+    /* Hand usable RAM to the frame allocator, except where the modules were loaded */
+    if (CHECK_FLAG(mbi->flags, 6)) {
+        memory_map_t *mmap;
+        for (mmap = (memory_map_t *)mbi->mmap_addr;
+                (unsigned long)mmap < mbi->mmap_addr + mbi->mmap_length;
+                mmap = (memory_map_t *)((unsigned long)mmap + mmap->size + sizeof (mmap->size))) {
+            if (mmap->type != 1 || mmap->base_addr_high != 0)
+                continue;
+            if (mmap->length_high != 0 || mmap->base_addr_low + mmap->length_low < mmap->base_addr_low)
+                frame_pool_add(mmap->base_addr_low, 0xFFFFFFFF);
+            else
+                frame_pool_add(mmap->base_addr_low, mmap->base_addr_low + mmap->length_low);
+        }
+    } else if (CHECK_FLAG(mbi->flags, 0)) {
+        /* mem_upper counts KB from 1MB */
+        frame_pool_add(0x100000, 0x100000 + mbi->mem_upper * 1024);
+    }
+    if (CHECK_FLAG(mbi->flags, 3)) {
+        unsigned int i;
+        module_t* mod = (module_t*)mbi->mods_addr;
+        for (i = 0; i < mbi->mods_count; i++, mod++)
+            frame_pool_reserve(mod->mod_start, mod->mod_end);
+    }
+    printf("Frame pool: %u free 4KB frames\n", frames_available());
+
     /* Construct an LDT entry in the GDT */
     {
         seg_desc_t the_ldt_desc;
@@ -154,6 +180,8 @@ void entry(unsigned long magic, unsigned long addr) {
         ltr(KERNEL_TSS);
     }
 
+    init_sysenter();
+
     {
         idt_desc_t syscall_idt_desc;
         syscall_idt_desc.seg_selector = KERNEL_CS;
@@ -241,6 +269,11 @@ void entry(unsigned long magic, unsigned long addr) {
 #ifdef RUN_TESTS
     /* Run tests */
     // launch_tests();
+#endif
+#ifdef RUN_BENCHMARKS
+    /* Leave the results on screen */
+    launch_benchmarks();
+    asm volatile (".2: hlt; jmp .2;");
 #endif
     /* Execute the first program ("shell") ... */
     clear();
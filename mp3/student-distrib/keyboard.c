@@ -6,6 +6,8 @@
 #include "terminal.h"
 #include "syscall.h"
 #include "pcb.h"
+#include "signal.h"
+#include "waitqueue.h"
 
 
 extern int rtc_flag;
@@ -22,6 +24,7 @@ uint8_t shift_flag = RELEASED;
 uint8_t ctrl_flag = RELEASED;
 uint8_t alt_flag = RELEASED;
 volatile uint8_t enter_flag[3] = {0,0,0};
+wait_queue_t enter_wait[3]; // read_terminal callers waiting for enter on each terminal
 
 char key_buf[BUF_LIMIT];
 uint8_t key_buf_idx;
@@ -238,17 +241,8 @@ void keypress(uint8_t _scancode)
 			key_buf_idx = 0;
             break;
 
-        case 'c': // ctrl+ c means return
-            // asm volatile(
-            //     "movl $1 , %%eax 
-            //      movl $-1, %%ebx
-            //      int $0x80 
-            //      popl %%ebx
-            //      ret"
-            //      :
-            //      :
-            //      :"eax", "ebx"
-            // );
+        case 'c': // ctrl + c interrupts the visible terminal's program
+            signal_raise(pid_to_pcb(terminal_processes[current_terminal]), SIG_INTERRUPT);
             return;
             break;
         }
@@ -305,7 +299,8 @@ void add_to_key_buf(char key)
  *      handles enter. clears key buffer and writes to terminal buffer
  *   Inputs: none
  *   Outputs: none
- *   Side effects: goes to next line, sets enter flag, clears buffer, sets terminal buffer
+ *   Side effects: goes to next line, sets enter flag, clears buffer, sets terminal buffer,
+ *                 wakes the terminal's readers
  */
 void enter()
 {
@@ -333,6 +328,7 @@ void enter()
     }
     enter_flag[current_terminal] = 1; // set enter flag
     key_buf_idx = 0; // set key buffer index
+    wake_up_all(&enter_wait[current_terminal]);
 }
 
 /*
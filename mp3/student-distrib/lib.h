@@ -94,6 +94,26 @@ static inline uint32_t inl(port) {
     return val;
 }
 
+/* Reads the low 32 bits of the time stamp counter */
+static inline uint32_t rdtsc(void) {
+    uint32_t val;
+    asm volatile ("rdtsc"
+            : "=a"(val)
+            :
+            : "edx"
+    );
+    return val;
+}
+
+/* Reads the whole time stamp counter */
+static inline uint64_t rdtsc64(void) {
+    uint64_t val;
+    asm volatile ("rdtsc"
+            : "=A"(val)
+    );
+    return val;
+}
+
 /* Writes a byte to a port */
 #define outb(data, port)                \
 do {                                    \
@@ -124,6 +144,18 @@ do {                                    \
     );                                  \
 } while (0)
 
+/* Writes a 32-bit value to a model specific register */
+#define wrmsr(msr, val)                 \
+do {                                    \
+    asm volatile ("wrmsr"               \
+            :                           \
+            : "c"(msr), "a"(val), "d"(0) \
+            : "memory"                  \
+    );                                  \
+} while (0)
+
+#ifndef HOST_HARNESS
+
 /* Clear interrupt flag - disables interrupts on this processor */
 #define cli()                           \
 do {                                    \
@@ -175,4 +207,15 @@ do {                                    \
     );                                  \
 } while (0)
 
+#else
+
+/* The host harness (mp3/host) runs in user mode, where cli and sti fault,
+ * and is single threaded, so there is nothing to keep interrupts off for */
+#define cli()                   do { } while (0)
+#define cli_and_save(flags)     do { (flags) = 0; } while (0)
+#define sti()                   do { } while (0)
+#define restore_flags(flags)    do { (void) (flags); } while (0)
+
+#endif /* HOST_HARNESS */
+
 #endif /* _LIB_H */
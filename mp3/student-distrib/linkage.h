@@ -5,3 +5,13 @@
 extern void keyboard_linker();
 extern void rtc_linker();
 extern void pit_linker();
+extern void page_fault_linker();
+extern void divide_by_zero_linker();
+extern void overflow_linker();
+extern void bound_range_linker();
+extern void opcode_linker();
+extern void stack_segment_fault_linker();
+extern void protection_fault_linker();
+extern void x87_floating_point_linker();
+extern void alignment_check_linker();
+extern void simd_floating_point_linker();
@@ -0,0 +1,161 @@
+#include "pagecache.h"
+#include "paging.h"
+#include "filesys.h"
+#include "lib.h"
+
+// Program images shared between processes, keyed by inode
+static pagecache_t pagecache[PAGECACHE_ENTRIES];
+
+/*
+ * pagecache_writable
+ *   DESCRIPTION: Reads a program's ELF program headers and marks the pages any writable
+ *                loadable segment touches. Everything is writable if the headers are unusable
+ *   INPUTS: inode - inode of the program image
+ *			 pages - number of pages in the image
+ *   OUTPUTS: none
+ *   RETURN VALUE: bitmap of writable pages
+ */
+static uint32_t pagecache_writable (uint32_t inode, uint32_t pages) {
+	uint32_t phoff;
+	uint16_t phnum;
+	uint32_t phdr[ELF_PHDR_SIZE / 4]; // p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz, p_flags, p_align
+	uint32_t writable;
+	uint32_t loads;
+	uint32_t first, last;
+	int i;
+
+	if (read_data(inode, ELF_PHOFF, (uint8_t *) &phoff, 4) != 4
+			|| read_data(inode, ELF_PHNUM, (uint8_t *) &phnum, 2) != 2) {
+		return 0xFFFFFFFF;
+	}
+
+	writable = 0;
+	loads = 0;
+	for (i = 0; i < phnum; i++) {
+		if (read_data(inode, phoff + i * ELF_PHDR_SIZE, (uint8_t *) phdr, ELF_PHDR_SIZE) != ELF_PHDR_SIZE) {
+			return 0xFFFFFFFF;
+		}
+
+		if (phdr[0] != PT_LOAD) {
+			continue;
+		}
+		loads++;
+
+		if (!(phdr[6] & PF_W) || phdr[5] == 0) {
+			continue;
+		}
+
+		// segment outside the image, can't tell what it shares a page with
+		if (phdr[2] < PROGRAM_VADDR) {
+			return 0xFFFFFFFF;
+		}
+
+		first = (phdr[2] - PROGRAM_VADDR) / FOUR_KI_B;
+		last = (phdr[2] + phdr[5] - 1 - PROGRAM_VADDR) / FOUR_KI_B;
+		for (; first <= last && first < pages; first++) {
+			writable |= 1 << first;
+		}
+	}
+
+	return (loads == 0) ? 0xFFFFFFFF : writable;
+}
+
+/*
+ * pagecache_entry
+ *   DESCRIPTION: Finds the cache entry for a program, creating one if needed. Creating may
+ *                evict a program no process has pages of
+ *   INPUTS: inode - inode of the program image
+ *   OUTPUTS: none
+ *   RETURN VALUE: the entry, NULL if the program can't be cached
+ */
+static pagecache_t * pagecache_entry (uint32_t inode) {
+	int i, j;
+	int32_t length;
+	pagecache_t * entry = NULL;
+
+	for (i = 0; i < PAGECACHE_ENTRIES; i++) {
+		if (pagecache[i].pages != 0 && pagecache[i].inode == inode) {
+			return &(pagecache[i]);
+		}
+	}
+
+	length = inode_length(inode);
+	if (length <= 0 || length > PAGECACHE_PAGES * FOUR_KI_B) {
+		return NULL;
+	}
+
+	// take an unused entry, else one whose frames are only held by the cache
+	for (i = 0; i < PAGECACHE_ENTRIES && entry == NULL; i++) {
+		if (pagecache[i].pages == 0) {
+			entry = &(pagecache[i]);
+		}
+	}
+
+	for (i = 0; i < PAGECACHE_ENTRIES && entry == NULL; i++) {
+		for (j = 0; j < pagecache[i].pages; j++) {
+			if (pagecache[i].frames[j] != 0 && frame_count((void *) pagecache[i].frames[j]) > 1) {
+				break;
+			}
+		}
+
+		if (j == pagecache[i].pages) {
+			entry = &(pagecache[i]);
+			for (j = 0; j < entry->pages; j++) {
+				frame_free((void *) entry->frames[j]);
+			}
+		}
+	}
+
+	if (entry == NULL) {
+		return NULL;
+	}
+
+	entry->inode = inode;
+	entry->pages = (length + FOUR_KI_B - 1) / FOUR_KI_B;
+	entry->writable = pagecache_writable(inode, entry->pages);
+	memset(entry->frames, 0, sizeof(entry->frames));
+
+	return entry;
+}
+
+/*
+ * pagecache_get
+ *   DESCRIPTION: Gets the frame holding one page of a program image, reading it from the
+ *                file system the first time any process touches it
+ *   INPUTS: inode - inode of the program image
+ *			 index - page index within the image
+ *   OUTPUTS: frame - physical address of the page, with a new reference for the caller
+ *			  writable - nonzero if the page holds writable data and must be copied on write
+ *   RETURN VALUE: -1 if the page can't be cached, 0 on success
+ */
+int32_t pagecache_get (uint32_t inode, uint32_t index, uint32_t * frame, uint32_t * writable) {
+	pagecache_t * entry;
+	void * page;
+
+	entry = pagecache_entry(inode);
+	if (entry == NULL || index >= entry->pages) {
+		return -1;
+	}
+
+	if (entry->frames[index] == 0) {
+		page = frame_alloc();
+		if (page == NULL) {
+			return -1;
+		}
+
+		// zero first so bss at the end of the last page starts clean
+		memset(page, 0, FOUR_KI_B);
+		if (read_data(inode, index * FOUR_KI_B, page, FOUR_KI_B) == -1) {
+			frame_free(page);
+			return -1;
+		}
+
+		entry->frames[index] = (uint32_t) page;
+	}
+
+	frame_ref((void *) entry->frames[index]);
+	*frame = entry->frames[index];
+	*writable = (entry->writable >> index) & 1;
+
+	return 0;
+}
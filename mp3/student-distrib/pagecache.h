@@ -0,0 +1,26 @@
+#ifndef _PAGECACHE_H
+#define _PAGECACHE_H
+
+#include "types.h"
+
+#define PAGECACHE_ENTRIES 8 // programs cached at once
+#define PAGECACHE_PAGES 32 // pages cached per program, images up to 128KiB
+
+// ELF fields needed to tell text pages from data pages
+#define ELF_PHOFF 28 // offset of e_phoff in the ELF header
+#define ELF_PHNUM 44 // offset of e_phnum in the ELF header
+#define ELF_PHDR_SIZE 32
+#define PT_LOAD 1
+#define PF_W 0x2
+
+// Executable page cache entry, one per program image
+typedef struct pagecache_entry {
+	uint32_t inode; // inode of the program image
+	uint32_t pages; // number of pages in the image, 0 if the entry is unused
+	uint32_t writable; // bitmap of pages holding a writable segment
+	uint32_t frames[PAGECACHE_PAGES]; // frame holding each page, 0 until first touched
+} pagecache_t;
+
+extern int32_t pagecache_get (uint32_t inode, uint32_t index, uint32_t * frame, uint32_t * writable);
+
+#endif
@@ -2,11 +2,23 @@
 #include "types.h"
 #include "lib.h"
 #include "syscall.h"
+#include "filesys.h"
+#include "pagecache.h"
 
 // Static arrays for use as page directory and first two pages
 static uint32_t page_directory[PAGE_TABLE_SIZE] __attribute__((aligned(FOUR_KI_B))); // creation of a 1KiB directory alligned every 4KiB
 static uint32_t active_page_table[PAGE_TABLE_SIZE] __attribute__((aligned(FOUR_KI_B))); // creation of a table of 4KiB pages
 static uint32_t vidmap_table[PAGE_TABLE_SIZE] __attribute__((aligned(FOUR_KI_B)));;
+
+static pcb_t * paged_pcb = NULL; // process whose user memory is currently mapped
+
+// Frame pool bookkeeping
+static uint8_t frame_usable[FRAME_COUNT / 8]; // bitmap of frames the memory map says are free RAM
+static uint16_t frame_refs[FRAME_COUNT]; // number of references to each frame, 0 if free
+static uint32_t frame_hint = 0; // index to start the next search at
+static uint32_t frames_free = 0; // usable frames with no references
+
+#define FRAME_USABLE(frame) (frame_usable[(frame) / 8] & (1 << ((frame) % 8)))
 /*
  * allow_paging
  *   DESCRIPTION: Sets the system to use enable paging with a given directory
@@ -28,7 +40,7 @@ void allow_paging(unsigned int pd){
 			orl $0x00000010, %%eax #enable PSE \n\
 			movl %%eax, %%cr4 \n\
 			movl %%cr0, %%eax								\n\
-			orl $0x80000001, %%eax	#done to set the paging allowed bit	\n\
+			orl $0x80010001, %%eax	#set the paging allowed bit, and write protect so the kernel honors read-only user pages	\n\
 			movl %%eax, %%cr0		#move into CR0 to permit paging		\n\
 			"
 		 :  // no output registers
@@ -84,6 +96,11 @@ void init_pages(){
 	 // turn on 4MiB page in directory
 	 page_directory[1] = ((unsigned int) FOUR_MI_B) | 0x83; // set to page size to 4MiB by turning on bit 7, 0b10000011 = 0x83
 
+	 // identity map the frame pool for the kernel only
+	 for (page = FRAME_POOL_START; page < FRAME_POOL_END; page += FOUR_MI_B) {
+	 	page_directory[page / FOUR_MI_B] = page | 0x83;
+	 }
+
 	 allow_paging((unsigned int) page_directory); // allows paging to happen
 }
 
@@ -167,3 +184,471 @@ void page_on_4kb (void * phys_addr, void * virt_addr) {
 	 : "%eax" // clobbers eax
 	 );
 }
+
+/*
+ * frame_pool_add
+ *   DESCRIPTION: Adds the whole frames of a range of usable RAM to the frame pool. Only the
+ *                part between FRAME_POOL_START and FRAME_POOL_END is identity mapped, so the
+ *                rest is ignored
+ *   INPUTS: start - first address of the range
+ *			 end - address one past the end of the range
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Marks the frames usable
+ */
+void frame_pool_add (uint32_t start, uint32_t end) {
+	uint32_t addr;
+	uint32_t frame;
+
+	if (start < FRAME_POOL_START) {
+		start = FRAME_POOL_START;
+	}
+	if (end > FRAME_POOL_END) {
+		end = FRAME_POOL_END;
+	}
+
+	for (addr = (start + FOUR_KI_B - 1) & ~(FOUR_KI_B - 1); addr < end && end - addr >= FOUR_KI_B; addr += FOUR_KI_B) {
+		frame = (addr - FRAME_POOL_START) / FOUR_KI_B;
+		if (!FRAME_USABLE(frame)) {
+			frame_usable[frame / 8] |= 1 << (frame % 8);
+			if (frame_refs[frame] == 0) {
+				frames_free++;
+			}
+		}
+	}
+}
+
+/*
+ * frame_pool_reserve
+ *   DESCRIPTION: Takes every frame touching a range out of the frame pool, for memory the
+ *                boot loader put something in
+ *   INPUTS: start - first address of the range
+ *			 end - address one past the end of the range
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Marks the frames unusable
+ */
+void frame_pool_reserve (uint32_t start, uint32_t end) {
+	uint32_t addr;
+	uint32_t frame;
+
+	if (start < FRAME_POOL_START) {
+		start = FRAME_POOL_START;
+	}
+	if (end > FRAME_POOL_END) {
+		end = FRAME_POOL_END;
+	}
+
+	for (addr = start & ~(FOUR_KI_B - 1); addr < end; addr += FOUR_KI_B) {
+		frame = (addr - FRAME_POOL_START) / FOUR_KI_B;
+		if (FRAME_USABLE(frame)) {
+			frame_usable[frame / 8] &= ~(1 << (frame % 8));
+			if (frame_refs[frame] == 0) {
+				frames_free--;
+			}
+		}
+	}
+}
+
+/*
+ * frames_available
+ *   DESCRIPTION: Gets the number of free frames in the pool
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: free frame count
+ */
+uint32_t frames_available () {
+	return frames_free;
+}
+
+/*
+ * frames_alloc
+ *   DESCRIPTION: Allocates physically contiguous 4KiB frames from the frame pool, aligned to
+ *                their combined size
+ *   INPUTS: count - number of frames, a power of two
+ *   OUTPUTS: none
+ *   RETURN VALUE: address of the first frame (identity mapped for the kernel), NULL if no run
+ *                 of free frames is long enough
+ *   SIDE EFFECTS: Gives each frame one reference
+ */
+void * frames_alloc (uint32_t count) {
+	uint32_t i;
+	uint32_t j;
+	uint32_t first;
+
+	if (count == 0 || count > FRAME_COUNT || frames_free < count) {
+		return NULL;
+	}
+
+	for (i = 0; i < FRAME_COUNT; i += count) {
+		first = ((frame_hint & ~(count - 1)) + i) % FRAME_COUNT;
+		for (j = 0; j < count; j++) {
+			if (!FRAME_USABLE(first + j) || frame_refs[first + j] != 0) {
+				break;
+			}
+		}
+
+		if (j == count) {
+			for (j = 0; j < count; j++) {
+				frame_refs[first + j] = 1;
+			}
+			frames_free -= count;
+			frame_hint = (first + count) % FRAME_COUNT;
+			return (void *) (FRAME_POOL_START + first * FOUR_KI_B);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * frame_alloc
+ *   DESCRIPTION: Allocates a 4KiB physical frame from the frame pool
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: address of the frame (identity mapped for the kernel), NULL if the pool is empty
+ *   SIDE EFFECTS: Gives the frame one reference
+ */
+void * frame_alloc () {
+	return frames_alloc(1);
+}
+
+/*
+ * frame_ref
+ *   DESCRIPTION: Takes another reference to an allocated frame, for sharing it
+ *   INPUTS: frame - address returned by frame_alloc
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Increments the frame's reference count
+ */
+void frame_ref (void * frame) {
+	uint32_t addr = (uint32_t) frame;
+
+	if (addr < FRAME_POOL_START || addr >= FRAME_POOL_END) {
+		return;
+	}
+
+	frame_refs[(addr - FRAME_POOL_START) / FOUR_KI_B]++;
+}
+
+/*
+ * frame_count
+ *   DESCRIPTION: Gets the number of references to a frame
+ *   INPUTS: frame - address returned by frame_alloc
+ *   OUTPUTS: none
+ *   RETURN VALUE: reference count, 0 if free or not a pool frame
+ */
+uint32_t frame_count (void * frame) {
+	uint32_t addr = (uint32_t) frame;
+
+	if (addr < FRAME_POOL_START || addr >= FRAME_POOL_END) {
+		return 0;
+	}
+
+	return frame_refs[(addr - FRAME_POOL_START) / FOUR_KI_B];
+}
+
+/*
+ * frame_free
+ *   DESCRIPTION: Drops a reference to a frame, returning it to the pool on the last one
+ *   INPUTS: frame - address returned by frame_alloc
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Decrements the frame's reference count
+ */
+void frame_free (void * frame) {
+	uint32_t addr = (uint32_t) frame;
+
+	if (addr < FRAME_POOL_START || addr >= FRAME_POOL_END) {
+		return;
+	}
+
+	if (frame_refs[(addr - FRAME_POOL_START) / FOUR_KI_B] > 0) {
+		frame_refs[(addr - FRAME_POOL_START) / FOUR_KI_B]--;
+		if (frame_refs[(addr - FRAME_POOL_START) / FOUR_KI_B] == 0) {
+			frames_free++;
+		}
+	}
+}
+
+/*
+ * user_paging_alloc
+ *   DESCRIPTION: Gives a new process empty page tables for its 128MB region and mmap window
+ *   INPUTS: pcb - process to set up
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if the frame pool is empty, 0 on success
+ *   SIDE EFFECTS: Allocates two frames
+ */
+int32_t user_paging_alloc (pcb_t * pcb) {
+	pcb->user_table = (uint32_t *) frame_alloc();
+	pcb->mmap_table = (uint32_t *) frame_alloc();
+
+	if (pcb->user_table == NULL || pcb->mmap_table == NULL) {
+		frame_free(pcb->user_table);
+		frame_free(pcb->mmap_table);
+		pcb->user_table = NULL;
+		pcb->mmap_table = NULL;
+		return -1;
+	}
+
+	memset(pcb->user_table, 0, FOUR_KI_B);
+	memset(pcb->mmap_table, 0, FOUR_KI_B);
+	return 0;
+}
+
+/*
+ * user_paging_free
+ *   DESCRIPTION: Frees all of a process's user memory and its page tables
+ *   INPUTS: pcb - process to free
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Unmaps the process if it is currently mapped
+ */
+void user_paging_free (pcb_t * pcb) {
+	if (pcb->user_table == NULL) {
+		return;
+	}
+
+	mmap_release(pcb);
+	user_paging_release(pcb);
+	if (paged_pcb == pcb) {
+		process_paging(NULL);
+	}
+
+	frame_free(pcb->user_table);
+	frame_free(pcb->mmap_table);
+	pcb->user_table = NULL;
+	pcb->mmap_table = NULL;
+}
+
+/*
+ * process_paging
+ *   DESCRIPTION: Maps a process's user memory and mmap window into the page directory
+ *   INPUTS: pcb - process to map, NULL to unmap both
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Modifies page directory, flushes TLB
+ */
+void process_paging (pcb_t * pcb) {
+	if (pcb == NULL || pcb->user_table == NULL) {
+		page_directory[MMAP_VMEM / FOUR_MI_B] = 0x00000002;
+		page_directory[USER_VMEM / FOUR_MI_B] = 0x00000002;
+		paged_pcb = NULL;
+	} else {
+		// 7 turns on user/present/RW bits. Read-only and not-present are enforced per page
+		page_directory[MMAP_VMEM / FOUR_MI_B] = (uint32_t) pcb->mmap_table | 7;
+		page_directory[USER_VMEM / FOUR_MI_B] = (uint32_t) pcb->user_table | 7;
+		paged_pcb = pcb;
+	}
+
+	// flush tlb
+	asm volatile(
+		"movl %%cr3, %%eax \n\
+		movl %%eax, %%cr3 \n\
+		"
+	 :  // no output registers
+	 :  // no input registers
+	 : "%eax" // clobbers eax
+	 );
+}
+
+/*
+ * user_paging_release
+ *   DESCRIPTION: Drops all of the process's user pages, freeing its own frames and its
+ *                references to shared program frames
+ *   INPUTS: pcb - process to release
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Leaves every page not present. Caller flushes the TLB
+ */
+void user_paging_release (pcb_t * pcb) {
+	int i;
+
+	if (pcb == NULL || pcb->user_table == NULL) {
+		return;
+	}
+
+	for (i = 0; i < PAGE_TABLE_SIZE; i++) {
+		if (pcb->user_table[i] & PTE_FRAME) {
+			frame_free((void *) (pcb->user_table[i] & 0xFFFFF000));
+		}
+		pcb->user_table[i] = 0;
+	}
+}
+
+/*
+ * user_paging_init
+ *   DESCRIPTION: Empties a process's 128MB region. Each page gets a zeroed frame from the
+ *                pool on first touch
+ *   INPUTS: pcb - process to set up
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Modifies the process's user page table. Caller flushes the TLB
+ */
+void user_paging_init (pcb_t * pcb) {
+	user_paging_release(pcb);
+}
+
+/*
+ * user_paging_lazy
+ *   DESCRIPTION: Marks the pages a program image occupies as demand loaded, so each is read
+ *                from the file system on first access
+ *   INPUTS: pcb - process to set up
+ *			 inode - inode of the program image
+ *			 length - length of the program image in bytes
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 on failure, 0 on success
+ *   SIDE EFFECTS: Modifies the process's user page table. Caller flushes the TLB
+ */
+int32_t user_paging_lazy (pcb_t * pcb, uint32_t inode, uint32_t length) {
+	uint32_t i;
+	uint32_t first;
+
+	if (pcb == NULL || pcb->user_table == NULL) {
+		return -1;
+	}
+
+	first = (PROGRAM_VADDR - USER_VMEM) / FOUR_KI_B;
+	if (first + (length + FOUR_KI_B - 1) / FOUR_KI_B > PAGE_TABLE_SIZE) {
+		return -1;
+	}
+
+	pcb->lazy_inode = inode;
+	for (i = 0; i * FOUR_KI_B < length; i++) {
+		pcb->user_table[first + i] = PTE_LAZY | PTE_USER | PTE_RW;
+	}
+
+	return 0;
+}
+
+/*
+ * page_fault_handler
+ *   DESCRIPTION: Called by the page fault linkage. Fills in demand-loaded program pages,
+ *                sharing them through the exec page cache when possible, gives any other
+ *                page of the 128MB region a zeroed frame on first touch, and breaks
+ *                copy-on-write sharing of program data pages on the first write
+ *   INPUTS: addr - faulting address from CR2
+ *			 error - error code pushed by the processor
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 if the fault was handled and the access can be retried, -1 otherwise
+ *   SIDE EFFECTS: Maps the page and copies program data into it
+ */
+int32_t page_fault_handler (uint32_t addr, uint32_t error) {
+	uint32_t * pte;
+	uint32_t page;
+	uint32_t index;
+	uint32_t frame;
+	uint32_t copy;
+	uint32_t writable;
+
+	// only faults inside the current process's 128MB region
+	if (paged_pcb == NULL || addr < USER_VMEM || addr >= USER_VMEM + FOUR_MI_B) {
+		return -1;
+	}
+
+	index = (addr - USER_VMEM) / FOUR_KI_B;
+	pte = &(paged_pcb->user_table[index]);
+	page = addr & 0xFFFFF000;
+
+	if (!(error & PF_PRESENT) && (*pte & PTE_LAZY)) {
+		// first touch of a program page, share it from the page cache
+		if (pagecache_get(paged_pcb->lazy_inode, (page - PROGRAM_VADDR) / FOUR_KI_B, &frame, &writable) == 0) {
+			// writable pages are mapped read-only until the first write
+			*pte = frame | PTE_FRAME | PTE_USER | PTE_PRESENT | (writable ? PTE_COW : 0);
+			asm volatile("invlpg (%0)" : : "r" (page) : "memory");
+			return 0;
+		}
+
+		// not cacheable, map a private frame and read its slice of the program image through the new mapping
+		frame = (uint32_t) frame_alloc();
+		if (frame == 0) {
+			return -1;
+		}
+		memset((void *) frame, 0, FOUR_KI_B);
+		*pte = frame | PTE_FRAME | PTE_USER | PTE_RW | PTE_PRESENT;
+		asm volatile("invlpg (%0)" : : "r" (page) : "memory");
+
+		if (read_data(paged_pcb->lazy_inode, page - PROGRAM_VADDR, (uint8_t *) page, FOUR_KI_B) == -1) {
+			return -1;
+		}
+
+		return 0;
+	}
+
+	if (!(error & PF_PRESENT)) {
+		// first touch of a stack, bss or heap page
+		frame = (uint32_t) frame_alloc();
+		if (frame == 0) {
+			return -1;
+		}
+		memset((void *) frame, 0, FOUR_KI_B);
+		*pte = frame | PTE_FRAME | PTE_USER | PTE_RW | PTE_PRESENT;
+		asm volatile("invlpg (%0)" : : "r" (page) : "memory");
+		return 0;
+	}
+
+	if ((error & PF_WRITE) && (*pte & PTE_COW)) {
+		// first write to a shared data page, copy it into a frame of the process's own
+		frame = *pte & 0xFFFFF000;
+		copy = (uint32_t) frame_alloc();
+		if (copy == 0) {
+			return -1;
+		}
+		memcpy((void *) copy, (void *) frame, FOUR_KI_B);
+		*pte = copy | PTE_FRAME | PTE_USER | PTE_RW | PTE_PRESENT;
+		asm volatile("invlpg (%0)" : : "r" (page) : "memory");
+
+		frame_free((void *) frame);
+		return 0;
+	}
+
+	return -1;
+}
+
+/*
+ * mmap_page
+ *   DESCRIPTION: Maps one 4KiB page into a process's mmap window, freeing any pool frame
+ *                previously mapped there
+ *   INPUTS: pcb - process owning the window
+ *			 index - page index within the window
+ *			 phys_addr - page aligned physical address to map
+ *			 flags - page table entry bits, 0 to unmap
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 on failure, 0 on success
+ *   SIDE EFFECTS: Modifies the process's mmap page table. Caller flushes the TLB
+ */
+int32_t mmap_page (pcb_t * pcb, uint32_t index, void * phys_addr, uint32_t flags) {
+	if (pcb == NULL || pcb->mmap_table == NULL || index >= PAGE_TABLE_SIZE) {
+		return -1;
+	}
+
+	if (pcb->mmap_table[index] & PTE_FRAME) {
+		frame_free((void *) (pcb->mmap_table[index] & 0xFFFFF000));
+	}
+
+	pcb->mmap_table[index] = ((uint32_t) phys_addr & 0xFFFFF000) | flags;
+	return 0;
+}
+
+/*
+ * mmap_release
+ *   DESCRIPTION: Unmaps a process's whole mmap window and frees any pool frames in it
+ *   INPUTS: pcb - process owning the window
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Modifies the process's mmap page table
+ */
+void mmap_release (pcb_t * pcb) {
+	int i;
+
+	if (pcb == NULL || pcb->mmap_table == NULL) {
+		return;
+	}
+
+	for (i = 0; i < PAGE_TABLE_SIZE; i++) {
+		if (pcb->mmap_table[i] & PTE_FRAME) {
+			frame_free((void *) (pcb->mmap_table[i] & 0xFFFFF000));
+		}
+		pcb->mmap_table[i] = 0;
+	}
+}
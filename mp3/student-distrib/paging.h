@@ -1,8 +1,35 @@
+#ifndef _PAGING_H
+#define _PAGING_H
+
+#include "types.h"
+#include "pcb.h"
+
 #define PAGE_TABLE_SIZE 1024
 #define FOUR_KI_B 4096
 #define FOUR_MI_B 4194304
 #define VIDEO_PAGE 0xB8
 #define VIDEO_ADDR 0xB8000
+#define USER_VMEM (FOUR_MI_B * 32) // 128MB, where user programs live
+#define MMAP_VMEM (FOUR_MI_B * 34) // 136MB, window for mmap'd files
+#define PROGRAM_VADDR 0x08048000 // where program images are loaded
+
+// Physical pool of 4KiB frames: whatever the memory map says is usable between the kernel's
+// 4MB page and the user region, where the pool is identity mapped for the kernel
+#define FRAME_POOL_START (FOUR_MI_B * 2)
+#define FRAME_POOL_END USER_VMEM
+#define FRAME_COUNT ((FRAME_POOL_END - FRAME_POOL_START) / FOUR_KI_B)
+
+// Page table entry bits
+#define PTE_PRESENT 0x1
+#define PTE_RW 0x2
+#define PTE_USER 0x4
+#define PTE_FRAME 0x200 // available bit, marks a frame owned by the pool
+#define PTE_LAZY 0x400 // available bit, marks a program page not yet read from the file system
+#define PTE_COW 0x800 // available bit, marks a read-only shared page that is copied on write
+
+// Page fault error code bits
+#define PF_PRESENT 0x1 // fault on a present page
+#define PF_WRITE 0x2 // fault on a write
 
 extern void allow_paging(unsigned int page_directory);
 extern void init_pages();
@@ -10,3 +37,22 @@ extern void page_on_4mb (void * phys_addr, void * virt_addr);
 extern void page_off_4mb (void * virt_addr);
 extern void page_on_4kb (void * phys_addr, void * virt_addr);
 extern void video_page_remap (void * phys_addr, void * virt_addr);
+extern void frame_pool_add (uint32_t start, uint32_t end);
+extern void frame_pool_reserve (uint32_t start, uint32_t end);
+extern uint32_t frames_available ();
+extern void * frames_alloc (uint32_t count);
+extern void * frame_alloc ();
+extern void frame_ref (void * frame);
+extern uint32_t frame_count (void * frame);
+extern void frame_free (void * frame);
+extern int32_t user_paging_alloc (pcb_t * pcb);
+extern void user_paging_free (pcb_t * pcb);
+extern void process_paging (pcb_t * pcb);
+extern void user_paging_init (pcb_t * pcb);
+extern void user_paging_release (pcb_t * pcb);
+extern int32_t user_paging_lazy (pcb_t * pcb, uint32_t inode, uint32_t length);
+extern int32_t page_fault_handler (uint32_t addr, uint32_t error);
+extern int32_t mmap_page (pcb_t * pcb, uint32_t index, void * phys_addr, uint32_t flags);
+extern void mmap_release (pcb_t * pcb);
+
+#endif
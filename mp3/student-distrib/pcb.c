@@ -1,10 +1,18 @@
 #include "pcb.h"
 #include "filesys.h"
 #include "terminal.h"
+#include "paging.h"
+#include "sysstat.h"
+#include "lib.h"
 
 // Operations table entries for stdio
-static operations_t std_in_ops = {.open_op = open_terminal, .read_op = read_terminal, .write_op = NULL, .close_op = close_terminal };
-static operations_t std_out_ops = {.open_op = open_terminal, .read_op = NULL, .write_op = write_terminal, .close_op = close_terminal };
+static operations_t std_in_ops = {.open_op = open_terminal, .read_op = read_terminal, .write_op = NULL, .close_op = close_terminal, .poll_op = poll_stdin };
+static operations_t std_out_ops = {.open_op = open_terminal, .read_op = NULL, .write_op = write_terminal, .close_op = close_terminal, .poll_op = poll_stdout };
+
+// PCB of every live process, indexed by pid
+static pcb_t * pid_table[PID_MAX];
+// Any live process, the rest follow through next_task
+pcb_t * pcb_list = NULL;
 
 
 /*
@@ -21,7 +29,154 @@ pcb_t * get_pcb () {
 		 
 	);
 		 
-	return (pcb_t *) ((unsigned int) esp & 0xFFFFE000); // align address to 8kB
+	return (pcb_t *) ((unsigned int) esp & ~(KSTACK_SIZE - 1)); // align address to 8kB
+}
+
+/*
+ *  current_process
+ *	Returns the PCB of the process whose kernel stack is in use
+ *  Input: none
+ *  Output: Pointer to PCB struct, NULL on the boot stack
+ */
+pcb_t * current_process () {
+	pcb_t * pcb = get_pcb();
+
+	return (pid_to_pcb(pcb->pid) == pcb) ? pcb : NULL;
+}
+
+/*
+ *  pid_to_pcb
+ *	Looks up a live process
+ *  Input: pid - process id
+ *  Output: Pointer to PCB struct, NULL if no process has that pid
+ */
+pcb_t * pid_to_pcb (int32_t pid) {
+	if (pid < 0 || pid >= PID_MAX) {
+		return NULL;
+	}
+
+	return pid_table[pid];
+}
+
+/*
+ *  pcb_alloc
+ *	Creates a process: a clean PCB and kernel stack in frames from the pool, empty user
+ *	page tables, and the lowest free pid
+ *  Input: none
+ *  Output: Pointer to PCB struct, NULL if out of pids or memory
+ */
+pcb_t * pcb_alloc () {
+	int32_t pid;
+	uint32_t i;
+	uint32_t flags;
+	pcb_t * pcb;
+
+	for (pid = 1; pid < PID_MAX; pid++) {
+		if (pid_table[pid] == NULL) {
+			break;
+		}
+	}
+	if (pid == PID_MAX) {
+		return NULL;
+	}
+
+	pcb = (pcb_t *) frames_alloc(KSTACK_SIZE / FOUR_KI_B);
+	if (pcb == NULL) {
+		return NULL;
+	}
+
+	clean_pcb(pcb);
+	pcb->user_table = NULL;
+	pcb->mmap_table = NULL;
+	pcb->lazy_inode = 0;
+	if (user_paging_alloc(pcb) == -1) {
+		for (i = 0; i < KSTACK_SIZE; i += FOUR_KI_B) {
+			frame_free((uint8_t *) pcb + i);
+		}
+		return NULL;
+	}
+
+	pcb->pid = pid;
+	sysstat_reset(pid);
+
+	cli_and_save(flags);
+	pid_table[pid] = pcb;
+	if (pcb_list == NULL) {
+		pcb->next_task = pcb;
+		pcb_list = pcb;
+	} else {
+		pcb->next_task = pcb_list->next_task;
+		pcb_list->next_task = pcb;
+	}
+	restore_flags(flags);
+
+	return pcb;
+}
+
+/*
+ *  pcb_free
+ *	Frees a process's memory, page tables, kernel stack and pid. Must not be called
+ *	while running on that kernel stack
+ *  Input: pcb - process to free
+ *  Output: none
+ */
+void pcb_free (pcb_t * pcb) {
+	uint32_t i;
+	uint32_t flags;
+	pcb_t * prev;
+
+	if (pcb == NULL || pid_to_pcb(pcb->pid) != pcb) {
+		return;
+	}
+
+	cli_and_save(flags);
+	timer_cancel(&(pcb->sleep_timer));
+	wait_remove(pcb);
+	pid_table[pcb->pid] = NULL;
+	for (prev = pcb; prev->next_task != pcb; prev = prev->next_task);
+	prev->next_task = pcb->next_task;
+	if (pcb_list == pcb) {
+		pcb_list = (pcb->next_task == pcb) ? NULL : pcb->next_task;
+	}
+	restore_flags(flags);
+
+	user_paging_free(pcb);
+	for (i = 0; i < KSTACK_SIZE; i += FOUR_KI_B) {
+		frame_free((uint8_t *) pcb + i);
+	}
+}
+
+/*
+ *  pcb_add_child
+ *	Links a new process into its parent's child list
+ *  Input: parent - parent process
+ *         child - new child process
+ *  Output: none
+ */
+void pcb_add_child (pcb_t * parent, pcb_t * child) {
+	child->parent = parent;
+	child->sibling = parent->children;
+	parent->children = child;
+}
+
+/*
+ *  pcb_remove_child
+ *	Unlinks a process from its parent's child list
+ *  Input: parent - parent process
+ *         child - child to remove
+ *  Output: none
+ */
+void pcb_remove_child (pcb_t * parent, pcb_t * child) {
+	pcb_t ** link;
+
+	for (link = &(parent->children); *link != NULL; link = &((*link)->sibling)) {
+		if (*link == child) {
+			*link = child->sibling;
+			break;
+		}
+	}
+	child->parent = NULL;
+	child->sibling = NULL;
 }
 
 /*
@@ -31,9 +186,16 @@ pcb_t * get_pcb () {
  *  Output: none
  */
 void clean_pcb (pcb_t * ptr) {
+	int i;
+
 	ptr->pid = 0;
 	ptr->parent = NULL;
-	ptr->child = NULL;
+	ptr->children = NULL;
+	ptr->sibling = NULL;
+	ptr->next_task = NULL;
+	ptr->state = PROC_BLOCKED;
+	ptr->background = 0;
+	ptr->exit_status = 0;
 	ptr->parent_esp = 0;
 	ptr->parent_ebp = 0;
 	ptr->esp = 0;
@@ -42,7 +204,21 @@ void clean_pcb (pcb_t * ptr) {
 	ptr->terminal = -1;
 	ptr->freq = 2; // default to 2
 	ptr->freq_wait = 0;
+	ptr->rtc_armed = 0;
 	*(ptr->args) = '\0';
+	ptr->mmap_pages = 0;
+	for (i = 0; i < NUM_SIGNALS; i++) {
+		ptr->sig_handlers[i] = NULL;
+	}
+	ptr->sig_pending = 0;
+	ptr->sig_masked = 0;
+	ptr->alarm_period = ALARM_DEFAULT_MS;
+	ptr->alarm_left = ALARM_DEFAULT_MS;
+	ptr->sleep_timer.next = NULL;
+	ptr->sleep_timer.pprev = NULL;
+	ptr->wait_queue = NULL;
+	ptr->wait_next = NULL;
+	wait_queue_init(&(ptr->child_exit));
 }
 
 /*
@@ -59,13 +235,15 @@ void init_farray (pcb_t * ptr) {
 	ptr->file_array[0].operations_pointer = &std_in_ops;
 	ptr->file_array[0].inode_num = 0;
 	ptr->file_array[0].file_pos = 0;
-	ptr->file_array[0].flags |= 0x1;
+	ptr->file_array[0].flags = FD_IN_USE;
+	ptr->file_array[0].pipe = NULL;
 	
 	// initialize std_out
 	ptr->file_array[1].operations_pointer = &std_out_ops;
 	ptr->file_array[1].inode_num = 0;
 	ptr->file_array[1].file_pos = 0;
-	ptr->file_array[1].flags |= 0x1;
+	ptr->file_array[1].flags = FD_IN_USE;
+	ptr->file_array[1].pipe = NULL;
 
 	// initialize remaining entries to be empty
 	for (i = 2; i < FARRAY_SIZE; i++) {
@@ -73,6 +251,37 @@ void init_farray (pcb_t * ptr) {
 		ptr->file_array[i].inode_num = 0;
 		ptr->file_array[i].file_pos = 0;
 		ptr->file_array[i].flags = 0;
+		ptr->file_array[i].inode = NULL;
+		ptr->file_array[i].block_index = 0;
+		ptr->file_array[i].block_addr = NULL;
+		ptr->file_array[i].pipe = NULL;
 	}
 	
 }
+
+/*
+ *  inherit_farray
+ *	Gives a new process copies of its parent's open files, apart from close-on-exec ones,
+ *	and std io for any of fd 0,1 the parent does not pass on
+ *  Input: child - PCB to populate
+ *         parent - PCB to copy from, which must be the current process
+ *  Output: None
+ */
+void inherit_farray (pcb_t * child, pcb_t * parent) {
+	int i;
+	operations_t * ops;
+
+	init_farray(child);
+
+	for (i = 0; i < FARRAY_SIZE; i++) {
+		if (parent->file_array[i].flags == 0 || (parent->file_array[i].flags & FD_CLOEXEC)) {
+			continue;
+		}
+
+		ops = parent->file_array[i].operations_pointer;
+		if (ops != NULL && ops->dup_op != NULL) {
+			ops->dup_op(i);
+		}
+		memcpy(&(child->file_array[i]), &(parent->file_array[i]), sizeof(farray_t));
+	}
+}
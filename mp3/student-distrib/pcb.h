@@ -3,13 +3,31 @@
 
 #include "types.h"
 #include "filesys.h"
+#include "signal.h"
+#include "timer.h"
+#include "waitqueue.h"
 
 #define ARG_LIMIT 128
+#define KSTACK_SIZE 8192 // PCB at the bottom, kernel stack growing down from the top
+#define PID_MAX 4096 // more processes than fit in the frame pool, pid 0 is never used
+
+// Scheduler states
+#define PROC_RUNNABLE 0
+#define PROC_BLOCKED 1 // not started yet, in execute until its foreground child halts, asleep or on a wait queue
+#define PROC_ZOMBIE 2 // halted, until its parent reaps it with wait
+
+// esp0 for a process entering the kernel
+#define KSTACK_TOP(pcb) ((uint32_t) (pcb) + KSTACK_SIZE - 4)
 
 typedef struct pcb_t {
 	uint32_t pid; // process id
 	struct pcb_t * parent; // parent process
-	struct pcb_t * child; // child process
+	struct pcb_t * children; // first child process, linked through sibling
+	struct pcb_t * sibling; // next child of the same parent
+	struct pcb_t * next_task; // next live process, in a ring of all of them
+	uint8_t state; // PROC_RUNNABLE, PROC_BLOCKED or PROC_ZOMBIE
+	uint8_t background; // started by spawn, so halting leaves a zombie for wait
+	uint32_t exit_status; // halt status of a zombie, HALT_EXCEPTION if it was killed
 	uint32_t parent_esp;
 	uint32_t parent_ebp;
 	uint32_t esp; 	// process esp
@@ -18,12 +36,35 @@ typedef struct pcb_t {
 	uint8_t terminal; // terminal process is running on
 	uint8_t freq; //For vitualized RTC
 	uint8_t freq_wait; //For virtualized RTC, default to 0
+	uint8_t rtc_armed; //For virtualized RTC, set while freq_wait counts down for poll
 	uint8_t args[ARG_LIMIT];	// process arguments
+	uint32_t mmap_pages; // pages used in the process's mmap window
+	uint32_t * user_table; // page table of the process's 128MB region
+	uint32_t * mmap_table; // page table of the process's mmap window
+	uint32_t lazy_inode; // inode demand-loaded program pages are read from
+	void * sig_handlers[NUM_SIGNALS]; // user handler of each signal, NULL for the default action
+	uint32_t sig_pending; // bit per signal raised but not yet delivered
+	uint8_t sig_masked; // set while a handler runs, until it calls sigreturn
+	uint32_t alarm_period; // milliseconds between ALARM signals, 0 for none
+	int32_t alarm_left; // milliseconds until the next ALARM
+	ktimer_t sleep_timer; // wakes the process from sleep
+	wait_queue_t * wait_queue; // queue the process is blocked on, NULL if none
+	struct pcb_t * wait_next; // next process on the same wait queue
+	wait_queue_t child_exit; // where wait sleeps until a background child halts
 } pcb_t;
 
+extern pcb_t * pcb_list;
+
 // returns pointer to PCB given ESP
 extern pcb_t * get_pcb ();
+extern pcb_t * current_process ();
+extern pcb_t * pid_to_pcb (int32_t pid);
+extern pcb_t * pcb_alloc ();
+extern void pcb_free (pcb_t * pcb);
+extern void pcb_add_child (pcb_t * parent, pcb_t * child);
+extern void pcb_remove_child (pcb_t * parent, pcb_t * child);
 extern void init_farray (pcb_t *);
+extern void inherit_farray (pcb_t * child, pcb_t * parent);
 extern void clean_pcb (pcb_t * ptr);
 
 #endif
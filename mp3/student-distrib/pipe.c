@@ -0,0 +1,252 @@
+#include "pipe.h"
+#include "pcb.h"
+#include "paging.h"
+#include "lib.h"
+
+// Operations table entries for the two ends of a pipe
+static operations_t pipe_read_ops = {.open_op = pipe_open, .read_op = pipe_read, .write_op = NULL, .close_op = pipe_close, .poll_op = pipe_poll, .dup_op = pipe_dup };
+static operations_t pipe_write_ops = {.open_op = pipe_open, .read_op = NULL, .write_op = pipe_write, .close_op = pipe_close, .poll_op = pipe_poll, .dup_op = pipe_dup };
+
+/*
+ * pipe_create
+ *   DESCRIPTION: Makes a pipe and opens both ends in the two lowest free file descriptors.
+ *                Both are close-on-exec, so programs only get one through dup2
+ *   INPUTS: none
+ *   OUTPUTS: fds - fds[0] is the read end, fds[1] the write end
+ *   RETURN VALUE: 0 on success, -1 if out of file descriptors or memory
+ *   SIDE EFFECTS: Modifies file array
+ */
+int32_t pipe_create (int32_t* fds) {
+	pcb_t* pcb = get_pcb();
+	pipe_t* pipe;
+	int32_t ends[2];
+	int32_t i, found;
+
+	// fd 0,1 are std io and never free
+	found = 0;
+	for (i = 2; i < FARRAY_SIZE && found < 2; i++) {
+		if (pcb->file_array[i].flags == 0) {
+			ends[found++] = i;
+		}
+	}
+	if (found < 2) {
+		return -1;
+	}
+
+	pipe = (pipe_t*) frame_alloc();
+	if (pipe == NULL) {
+		return -1;
+	}
+	pipe->read_pos = 0;
+	pipe->count = 0;
+	pipe->readers = 1;
+	pipe->writers = 1;
+	wait_queue_init(&(pipe->read_wait));
+	wait_queue_init(&(pipe->write_wait));
+
+	for (i = 0; i < 2; i++) {
+		pcb->file_array[ends[i]].operations_pointer = (i == 0) ? &pipe_read_ops : &pipe_write_ops;
+		pcb->file_array[ends[i]].inode_num = 0;
+		pcb->file_array[ends[i]].file_pos = 0;
+		pcb->file_array[ends[i]].flags = FD_IN_USE | FD_CLOEXEC;
+		pcb->file_array[ends[i]].inode = NULL;
+		pcb->file_array[ends[i]].block_index = 0;
+		pcb->file_array[ends[i]].block_addr = NULL;
+		pcb->file_array[ends[i]].pipe = pipe;
+		fds[i] = ends[i];
+	}
+
+	return 0;
+}
+
+/*
+ * pipe_open
+ *   DESCRIPTION: Pipes have no name, they are only made by pipe_create
+ *   INPUTS: filename - ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1
+ */
+int32_t pipe_open (const uint8_t* filename) {
+	return -1;
+}
+
+/*
+ * pipe_close
+ *   DESCRIPTION: Drops one end of a pipe. Readers see the end of the data once the last write
+ *                end closes, and writers fail once the last read end closes
+ *   INPUTS: fd - file descriptor of either end
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0
+ *   SIDE EFFECTS: Frees the pipe with its last end
+ */
+int32_t pipe_close (uint32_t fd) {
+	farray_t* file = &(get_pcb()->file_array[fd]);
+	pipe_t* pipe = file->pipe;
+	uint32_t flags;
+
+	cli_and_save(flags);
+	if (file->operations_pointer == &pipe_read_ops) {
+		pipe->readers--;
+		if (pipe->readers == 0) {
+			wake_up_all(&(pipe->write_wait));
+		}
+	} else {
+		pipe->writers--;
+		if (pipe->writers == 0) {
+			wake_up_all(&(pipe->read_wait));
+		}
+	}
+	if (pipe->readers == 0 && pipe->writers == 0) {
+		frame_free(pipe);
+	}
+	restore_flags(flags);
+
+	file->pipe = NULL;
+	return 0;
+}
+
+/*
+ * pipe_read
+ *   DESCRIPTION: Copies out whatever is in the pipe, up to nbytes, sleeping while it is
+ *                empty and a write end is still open
+ *   INPUTS: fd - file descriptor of a read end
+ *           nbytes - size of the buffer
+ *   OUTPUTS: buf - filled with the oldest bytes in the pipe
+ *   RETURN VALUE: number of bytes read, 0 once the pipe is empty with no write end left,
+ *                 -1 if a signal is about to kill the program
+ */
+int32_t pipe_read (uint32_t fd, void* buf, uint32_t nbytes) {
+	pcb_t* pcb = get_pcb();
+	pipe_t* pipe = pcb->file_array[fd].pipe;
+	uint32_t copied = 0;
+	uint32_t chunk;
+
+	if (nbytes == 0) {
+		return 0;
+	}
+
+	cli();
+	while (pipe->count == 0) {
+		if (pipe->writers == 0) {
+			sti();
+			return 0;
+		}
+		if (signal_fatal(pcb)) {
+			sti();
+			return -1;
+		}
+		wait_sleep(&(pipe->read_wait));
+		cli();
+	}
+
+	// at most two runs, up to the end of the ring and then from its start
+	while (copied < nbytes && pipe->count != 0) {
+		chunk = PIPE_SIZE - pipe->read_pos;
+		if (chunk > pipe->count) {
+			chunk = pipe->count;
+		}
+		if (chunk > nbytes - copied) {
+			chunk = nbytes - copied;
+		}
+		memcpy((uint8_t*) buf + copied, pipe->data + pipe->read_pos, chunk);
+		pipe->read_pos = (pipe->read_pos + chunk) % PIPE_SIZE;
+		pipe->count -= chunk;
+		copied += chunk;
+	}
+	wake_up_all(&(pipe->write_wait));
+	sti();
+
+	return copied;
+}
+
+/*
+ * pipe_write
+ *   DESCRIPTION: Copies the whole buffer into the pipe, sleeping until readers make room
+ *                whenever it is full
+ *   INPUTS: fd - file descriptor of a write end
+ *           buf - data to write
+ *           nbytes - number of bytes to write
+ *   OUTPUTS: none
+ *   RETURN VALUE: nbytes, or the bytes written before the last read end closed or a signal
+ *                 came to kill the program, -1 if that happened before any were
+ */
+int32_t pipe_write (uint32_t fd, const void* buf, uint32_t nbytes) {
+	pcb_t* pcb = get_pcb();
+	pipe_t* pipe = pcb->file_array[fd].pipe;
+	uint32_t copied = 0;
+	uint32_t write_pos;
+	uint32_t chunk;
+
+	cli();
+	while (copied < nbytes) {
+		if (pipe->readers == 0) {
+			sti();
+			return (copied != 0) ? (int32_t) copied : -1;
+		}
+		if (pipe->count == PIPE_SIZE) {
+			if (signal_fatal(pcb)) {
+				break;
+			}
+			wait_sleep(&(pipe->write_wait));
+			cli();
+			continue;
+		}
+
+		write_pos = (pipe->read_pos + pipe->count) % PIPE_SIZE;
+		chunk = PIPE_SIZE - write_pos;
+		if (chunk > PIPE_SIZE - pipe->count) {
+			chunk = PIPE_SIZE - pipe->count;
+		}
+		if (chunk > nbytes - copied) {
+			chunk = nbytes - copied;
+		}
+		memcpy(pipe->data + write_pos, (const uint8_t*) buf + copied, chunk);
+		pipe->count += chunk;
+		copied += chunk;
+		wake_up_all(&(pipe->read_wait));
+	}
+	sti();
+
+	return (copied != 0 || nbytes == 0) ? (int32_t) copied : -1;
+}
+
+/*
+ * pipe_poll
+ *   DESCRIPTION: A read end is ready with data in the pipe or no write end left, and a
+ *                write end with room in the pipe or no read end left
+ *   INPUTS: fd - file descriptor of either end
+ *   OUTPUTS: none
+ *   RETURN VALUE: POLLIN, POLLOUT or 0
+ */
+int32_t pipe_poll (uint32_t fd) {
+	farray_t* file = &(get_pcb()->file_array[fd]);
+	pipe_t* pipe = file->pipe;
+
+	if (file->operations_pointer == &pipe_read_ops) {
+		return (pipe->count != 0 || pipe->writers == 0) ? POLLIN : 0;
+	}
+	return (pipe->count != PIPE_SIZE || pipe->readers == 0) ? POLLOUT : 0;
+}
+
+/*
+ * pipe_dup
+ *   DESCRIPTION: Counts another open copy of a pipe end, made by dup2 or by a program
+ *                inheriting it
+ *   INPUTS: fd - file descriptor of either end
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0
+ */
+int32_t pipe_dup (uint32_t fd) {
+	farray_t* file = &(get_pcb()->file_array[fd]);
+	uint32_t flags;
+
+	cli_and_save(flags);
+	if (file->operations_pointer == &pipe_read_ops) {
+		file->pipe->readers++;
+	} else {
+		file->pipe->writers++;
+	}
+	restore_flags(flags);
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef _PIPE_H
+#define _PIPE_H
+
+#include "types.h"
+#include "paging.h"
+#include "waitqueue.h"
+
+#define PIPE_SIZE (FOUR_KI_B - 4 * sizeof(uint32_t) - 2 * sizeof(wait_queue_t)) // ring bytes left in the pipe's frame after the header
+
+// A pipe, in one frame from the frame pool. Freed once both ends are closed everywhere
+typedef struct pipe {
+	uint32_t read_pos; // index into data of the oldest unread byte
+	uint32_t count; // unread bytes
+	uint32_t readers; // open read ends, across all processes
+	uint32_t writers; // open write ends, across all processes
+	wait_queue_t read_wait; // readers waiting for data or the last write end to close
+	wait_queue_t write_wait; // writers waiting for room or the last read end to close
+	uint8_t data[PIPE_SIZE];
+} pipe_t;
+
+extern int32_t pipe_create (int32_t* fds);
+extern int32_t pipe_open (const uint8_t* filename);
+extern int32_t pipe_close (uint32_t fd);
+extern int32_t pipe_read (uint32_t fd, void* buf, uint32_t nbytes);
+extern int32_t pipe_write (uint32_t fd, const void* buf, uint32_t nbytes);
+extern int32_t pipe_poll (uint32_t fd);
+extern int32_t pipe_dup (uint32_t fd);
+
+#endif
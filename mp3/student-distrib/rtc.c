@@ -72,23 +72,20 @@ cp1_rtc_handler() {
  */
 void
 rtc_handler() {
-	int i;
 	pcb_t* pcb;
-	int pid;
 	send_eoi(RTC_IRQ_NUM);
 	outb(RTC_PORTC, RTC_PORT);		// select register C
 	inb(CMOS_PORT);				// just throw away contents
 	
-	for (i = 0; i < 3; i++) { 			//Loop through all processes that arent shell, extract pid
-		pid = terminal_processes[i];
-		if (pid < 3) {					//If process is a shell ignore it 
-			continue;
-		}
-		//Now get each PCB of the processes, and check its counter, if its not 0 then decrement it.
-		pcb = (pcb_t*) ((FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (pid + 1)));
-		if (pcb->freq_wait != 0) {
-			pcb->freq_wait--;
-		}
+	//Loop through every process, and check its counter, if its not 0 then decrement it.
+	pcb = pcb_list;
+	if (pcb != NULL) {
+		do {
+			if (pcb->freq_wait != 0) {
+				pcb->freq_wait--;
+			}
+			pcb = pcb->next_task;
+		} while (pcb != pcb_list);
 	}
 }
 
@@ -151,9 +148,31 @@ int32_t
 read_rtc(uint32_t fd, void* buf, uint32_t nbytes) {
 	pcb_t * pcb = get_pcb();
 	//Calculate the amount of iterations that the process needs to wait to simulate the desired frequency. 
-	pcb->freq_wait = 1024/(pcb->freq);
+	//If poll already started the countdown, finish that one instead
+	if (pcb->rtc_armed == 0) {
+		pcb->freq_wait = 1024/(pcb->freq);
+	}
+	pcb->rtc_armed = 0;
 	while (pcb->freq_wait != 0) {
 		// SPINNING
 	}
 	return 0;
 }
+
+/**
+  * poll_rtc()
+  * Reports whether a read would return without waiting. The first poll after
+  * a read starts the countdown to the next virtual tick, and the tick is
+  * ready once it reaches 0. The read that follows consumes it.
+  * Inputs: fd - ignored
+  * Outputs: Returns POLLIN if a tick is ready, 0 else
+ */
+int32_t
+poll_rtc(uint32_t fd) {
+	pcb_t * pcb = get_pcb();
+	if (pcb->rtc_armed == 0) {
+		pcb->freq_wait = 1024/(pcb->freq);
+		pcb->rtc_armed = 1;
+	}
+	return (pcb->freq_wait == 0) ? POLLIN : 0;
+}
@@ -18,3 +18,4 @@ extern int32_t open_rtc(const uint8_t* filename);
 extern int32_t close_rtc(uint32_t fd);
 extern int32_t write_rtc(uint32_t fd, const void* buf, uint32_t nbytes);
 extern int32_t read_rtc(uint32_t fd, void* buf, uint32_t nbytes);
+extern int32_t poll_rtc(uint32_t fd);
@@ -7,11 +7,15 @@
 #include "lib.h"
 #include "i8259.h"
 #include "syscall.h"
+#include "signal.h"
+#include "timer.h"
 
-#define USER_VMEM (FOUR_MI_B * 32)
-
-uint8_t round_robin_counter = 0; // number of terminal whose process currently being run
 uint8_t active_terminal = 0; // ID of visible terminal to switch to. Set by keyboard.
+volatile uint32_t pit_ticks = 0; // number of PIT interrupts since boot
+volatile uint32_t pit_tsc = 0; // TSC at the last PIT interrupt
+volatile uint32_t pit_max_gap = 0; // longest TSC gap between PIT interrupts, for interrupt latency
+volatile uint32_t idle_ticks = 0; // PIT interrupts that found the CPU idle
+static volatile uint8_t cpu_idle = 0; // set while the idle context halts
 
 // cursor stuff
 extern int screen_y;
@@ -36,7 +40,11 @@ void switch_task (int32_t new_pid) {
 	
 	// get pcbs
 	pcb_t * old_pcb = get_pcb();
-    pcb_t * new_pcb = (pcb_t*) ((FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (new_pid + 1)));
+    pcb_t * new_pcb = pid_to_pcb(new_pid);
+
+	if (new_pcb == NULL) {
+		return;
+	}
 
 	// set cursor to active task cursor
 	screen_x_cache[old_pcb->terminal] = screen_x;
@@ -70,11 +78,11 @@ void switch_task (int32_t new_pid) {
 	}
 
     // restore user space paging to 128MB
-    page_on_4mb ((void*) (FOUR_MI_B * 2 + (new_pid + 1) * FOUR_MI_B), (void*) (USER_VMEM));
+    process_paging (new_pcb);
 
     // set up TSS entry
 	tss.ss0 = KERNEL_DS;
-    tss.esp0 = (FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (new_pid)) - 4;
+    tss.esp0 = KSTACK_TOP(new_pcb);
 
 	// store ESP and EBP
 	asm volatile(
@@ -94,6 +102,118 @@ void switch_task (int32_t new_pid) {
     return;
 }
 
+/*
+ *  next_task
+ *	Picks the next runnable process after the current one in the ring of processes
+ *  Input: none
+ *  Output: pcb of the process to run, NULL if no other process can run
+ */
+pcb_t * next_task () {
+	pcb_t * current = current_process();
+	pcb_t * start = (current != NULL) ? current : pcb_list;
+	pcb_t * pcb = start;
+
+	if (pcb == NULL) {
+		return NULL;
+	}
+
+	do {
+		pcb = pcb->next_task;
+		if (pcb->state == PROC_RUNNABLE && pcb != current) {
+			return pcb;
+		}
+	} while (pcb != start);
+
+	return NULL;
+}
+
+/*
+ *  idle
+ *	The idle context, run when no process can: halts the CPU until the next interrupt.
+ *	A PIT tick that arrives meanwhile counts as idle time
+ *  Input: none
+ *  Output: none
+ *  Side effects: must be called with interrupts off, returns with them off
+ */
+void idle () {
+	cpu_idle = 1;
+	asm volatile("sti; hlt; cli");
+	cpu_idle = 0;
+}
+
+/*
+ *  yield
+ *	Gives up the rest of the time slice to the next runnable process, for a process
+ *	waiting on another one. Sleeps until the next interrupt if there is none
+ *  Input: none
+ *  Output: none
+ *  Side effects: must be called with interrupts off, returns with them on
+ */
+void yield () {
+	pcb_t * next = next_task();
+
+	if (next != NULL) {
+		switch_task(next->pid);
+	} else {
+		idle();
+	}
+	sti();
+}
+
+/*
+ *  block
+ *	Stops running the current process until something makes it runnable again. The
+ *	scheduler does not pick it meanwhile, and it sleeps until an interrupt if nothing else
+ *	can run
+ *  Input: none
+ *  Output: none
+ *  Side effects: must be called with interrupts off, after changing the process's state
+ *	from PROC_RUNNABLE, returns with them on
+ */
+void block () {
+	pcb_t * pcb = get_pcb();
+	pcb_t * next;
+
+	while (pcb->state != PROC_RUNNABLE) {
+		next = next_task();
+		if (next != NULL) {
+			switch_task(next->pid);
+		} else {
+			idle();
+		}
+	}
+	sti();
+}
+
+/*
+ *  reap_orphans
+ *	Frees halted processes whose parent halted first, so nothing will wait for them
+ *  Input: none
+ *  Output: none
+ *  Side effects: must run with interrupts off, off the stacks being freed
+ */
+static void reap_orphans () {
+	pcb_t * current = get_pcb();
+	pcb_t * pcb;
+	int found;
+
+	do {
+		found = 0;
+		pcb = pcb_list;
+		if (pcb == NULL) {
+			return;
+		}
+		do {
+			if (pcb->state == PROC_ZOMBIE && pcb->parent == NULL && pcb != current) {
+				pcb_free(pcb);
+				found = 1;
+				break;
+			}
+			pcb = pcb->next_task;
+		} while (pcb != pcb_list);
+	} while (found);
+}
+
 /*
  *  init_pit
  *	Starts the PIT and initalizes the clocking and channels
@@ -118,15 +238,32 @@ void init_pit() {
  *  Side effects: Grabs locks and stores EBP and ESP
  */
 void pit_handler() {
+	uint32_t now;
+	pcb_t * next;
+
 	send_eoi(PIT_IRQ_NUM);
 	cli();
-	// set to next task
-	round_robin_counter++;
-	round_robin_counter %= 3;
+	pit_ticks++;
+	now = rdtsc();
+	if (now - pit_tsc > pit_max_gap) {
+		pit_max_gap = now - pit_tsc;
+	}
+	pit_tsc = now;
+	// the tick ends the halt, and may switch away before idle clears the flag
+	if (cpu_idle) {
+		idle_ticks++;
+		cpu_idle = 0;
+	}
+	timer_tick();
+	signal_tick();
 	// reset terminal
 	swap_terminal(active_terminal);
-	// switch task
-	switch_task(terminal_processes[round_robin_counter]);
+	// switch to the next runnable process, if any
+	next = next_task();
+	if (next != NULL) {
+		switch_task(next->pid);
+	}
+	reap_orphans();
 	sti();
 	return;
 }
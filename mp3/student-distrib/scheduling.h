@@ -1,4 +1,5 @@
 #include "types.h"
+#include "pcb.h"
 
 #define PIT_COMMAND	0x43
 #define PIT_CHAN0	  0x40
@@ -6,7 +7,17 @@
 #define SQUARE_WAVE 0x36
 #define _20HZ       59659
 #define _100HZ      11931
+#define PIT_FREQ    100 // PIT interrupts per second
 
+extern volatile uint32_t pit_ticks;
+extern volatile uint32_t pit_tsc;
+extern volatile uint32_t pit_max_gap;
+extern volatile uint32_t idle_ticks;
+
+extern pcb_t * next_task ();
 extern void switch_task (int32_t new_pid);
+extern void idle ();
+extern void yield ();
+extern void block ();
 extern void init_pit();
 extern void pit_handler();
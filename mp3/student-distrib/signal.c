@@ -0,0 +1,206 @@
+#include "signal.h"
+#include "pcb.h"
+#include "syscall.h"
+#include "scheduling.h"
+#include "usercopy.h"
+#include "x86_desc.h"
+#include "lib.h"
+
+// movl $10, %eax; int $0x80; nop. Copied into each signal frame for the handler to return into
+static const uint8_t sigreturn_code[SIGRETURN_CODE_SIZE] = {0xB8, 0x0A, 0x00, 0x00, 0x00, 0xCD, 0x80, 0x90};
+
+/*
+ * signal_default_kills
+ *   DESCRIPTION: Tells whether a signal with no handler ends the process or is ignored
+ *   INPUTS: signum - signal number
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 to kill, 0 to ignore
+ */
+static int32_t signal_default_kills (int32_t signum) {
+	return (signum == SIG_DIV_ZERO || signum == SIG_SEGFAULT || signum == SIG_INTERRUPT);
+}
+
+/*
+ * signal_raise
+ *   DESCRIPTION: Marks a signal pending, to be delivered the next time the process returns
+ *                to user mode. Wakes a sleeping or waiting process if the signal is handled or kills
+ *   INPUTS: pcb - process to signal, ignored if NULL
+ *           signum - signal number
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+void signal_raise (pcb_t * pcb, int32_t signum) {
+	uint32_t flags;
+
+	if (pcb == NULL || signum < 0 || signum >= NUM_SIGNALS) {
+		return;
+	}
+
+	cli_and_save(flags);
+	pcb->sig_pending |= 1 << signum;
+	if ((timer_armed(&(pcb->sleep_timer)) || pcb->wait_queue != NULL)
+			&& (pcb->sig_handlers[signum] != NULL || signal_default_kills(signum))) {
+		timer_cancel(&(pcb->sleep_timer));
+		wait_remove(pcb);
+		pcb->state = PROC_RUNNABLE;
+	}
+	restore_flags(flags);
+}
+
+/*
+ * signal_fatal
+ *   DESCRIPTION: Checks for a pending signal that will kill the process, for waits that
+ *                should give up rather than hold it off
+ *   INPUTS: pcb - process to check
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if delivery will kill the process, 0 otherwise
+ */
+int32_t signal_fatal (pcb_t * pcb) {
+	int32_t signum;
+
+	for (signum = 0; signum < NUM_SIGNALS; signum++) {
+		if ((pcb->sig_pending & (1 << signum)) && pcb->sig_handlers[signum] == NULL
+				&& signal_default_kills(signum)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * signal_pending
+ *   DESCRIPTION: Checks whether returning to user mode has a signal to deliver, for the
+ *                SYSEXIT path, which cannot deliver one itself
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if do_signal has work, 0 otherwise
+ */
+int32_t signal_pending () {
+	pcb_t * pcb = get_pcb();
+
+	return (pcb->sig_pending != 0 && !pcb->sig_masked);
+}
+
+/*
+ * signal_tick
+ *   DESCRIPTION: Counts down every process's alarm by one PIT period, raising ALARM in
+ *                those that run out
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off
+ */
+void signal_tick () {
+	pcb_t * pcb = pcb_list;
+
+	if (pcb == NULL) {
+		return;
+	}
+
+	do {
+		if (pcb->alarm_period != 0 && pcb->state != PROC_ZOMBIE) {
+			pcb->alarm_left -= 1000 / PIT_FREQ;
+			if (pcb->alarm_left <= 0) {
+				signal_raise(pcb, SIG_ALARM);
+				pcb->alarm_left = pcb->alarm_period;
+			}
+		}
+		pcb = pcb->next_task;
+	} while (pcb != pcb_list);
+}
+
+/*
+ * signal_exception
+ *   DESCRIPTION: Turns an exception in user mode into a signal, if the process has a
+ *                handler for it
+ *   INPUTS: frame - saved context of the exception
+ *           signum - SIG_DIV_ZERO or SIG_SEGFAULT
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 if the signal was raised, -1 if the exception should end the process
+ */
+int32_t signal_exception (int_frame_t * frame, int32_t signum) {
+	pcb_t * pcb = current_process();
+
+	if ((frame->cs & 0x3) != 0x3 || pcb == NULL || pcb->sig_masked
+			|| pcb->sig_handlers[signum] == NULL) {
+		return -1;
+	}
+
+	signal_raise(pcb, signum);
+	return 0;
+}
+
+/*
+ * do_signal
+ *   DESCRIPTION: Delivers the lowest pending signal on the way back to user mode. A handled
+ *                one gets a frame on the user stack and the return goes to the handler instead,
+ *                with the other signals masked until it calls sigreturn. Unhandled ones take
+ *                their default action
+ *   INPUTS: frame - saved context the linkage is about to return to
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: May halt the process
+ */
+void do_signal (int_frame_t * frame) {
+	pcb_t * pcb;
+	sig_frame_t sig;
+	sig_frame_t * user;
+	int32_t signum;
+	uint32_t flags;
+
+	// only on the way back to user mode
+	if ((frame->cs & 0x3) != 0x3) {
+		return;
+	}
+	pcb = current_process();
+	if (pcb == NULL || pcb->sig_pending == 0 || pcb->sig_masked) {
+		return;
+	}
+
+	cli_and_save(flags);
+	while (pcb->sig_pending != 0) {
+		asm ("bsfl %1, %0" : "=r" (signum) : "r" (pcb->sig_pending));
+		pcb->sig_pending &= ~(1 << signum);
+
+		if (pcb->sig_handlers[signum] == NULL) {
+			if (signal_default_kills(signum)) {
+				process_halt(HALT_EXCEPTION);
+			}
+			continue;
+		}
+
+		sig.context.ebx = frame->ebx;
+		sig.context.ecx = frame->ecx;
+		sig.context.edx = frame->edx;
+		sig.context.esi = frame->esi;
+		sig.context.edi = frame->edi;
+		sig.context.ebp = frame->ebp;
+		sig.context.eax = frame->eax;
+		sig.context.ds = USER_DS;
+		sig.context.es = USER_DS;
+		sig.context.fs = USER_DS;
+		sig.context.signum = signum;
+		sig.context.eip = frame->eip;
+		sig.context.cs = frame->cs;
+		sig.context.eflags = frame->eflags;
+		sig.context.esp = frame->user_esp;
+		sig.context.ss = frame->user_ss;
+		memcpy(sig.code, sigreturn_code, SIGRETURN_CODE_SIZE);
+
+		user = (sig_frame_t *) (frame->user_esp - sizeof(sig_frame_t));
+		sig.ret_addr = (uint32_t) user->code;
+		sig.signum = signum;
+
+		// no room on the user stack for the frame
+		if (copy_to_user(user, &sig, sizeof(sig)) == -1) {
+			process_halt(HALT_EXCEPTION);
+		}
+
+		frame->eip = (uint32_t) pcb->sig_handlers[signum];
+		frame->user_esp = (uint32_t) user;
+		frame->eflags &= ~EFLAGS_DF; // handlers are C functions
+		pcb->sig_masked = 1;
+		break;
+	}
+	restore_flags(flags);
+}
@@ -0,0 +1,76 @@
+#ifndef _SIGNAL_H
+#define _SIGNAL_H
+
+#include "types.h"
+
+// Signal numbers, as in the user library
+#define SIG_DIV_ZERO	0 // divide error exception, kills by default
+#define SIG_SEGFAULT	1 // any other exception in user mode, kills by default
+#define SIG_INTERRUPT	2 // ctrl+c on the process's terminal, kills by default
+#define SIG_ALARM		3 // PIT alarm, ignored by default
+#define SIG_USER1		4 // ignored by default
+#define NUM_SIGNALS		5
+
+#define HALT_EXCEPTION 256 // halt status of a program killed by an exception or signal
+#define ALARM_DEFAULT_MS 10000 // ALARM period of a new program
+#define SIGRETURN_CODE_SIZE 8
+#define EFLAGS_USER 0xDD5 // flags a handler may change for sigreturn to restore: OF DF TF SF ZF AF PF CF
+#define EFLAGS_DF 0x400 // direction flag, clear for C code
+
+// Saved by an interrupt, exception or INT 0x80 linkage: pushfl over pushal over the
+// processor's frame. user_esp and user_ss are only there when it came from user mode
+typedef struct int_frame {
+	uint32_t flags;
+	uint32_t edi;
+	uint32_t esi;
+	uint32_t ebp;
+	uint32_t esp; // not restored by popal
+	uint32_t ebx;
+	uint32_t edx;
+	uint32_t ecx;
+	uint32_t eax;
+	uint32_t eip;
+	uint32_t cs;
+	uint32_t eflags;
+	uint32_t user_esp;
+	uint32_t user_ss;
+} int_frame_t;
+
+// Hardware context a handler finds above its signal number, and sigreturn restores
+typedef struct sig_context {
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+	uint32_t esi;
+	uint32_t edi;
+	uint32_t ebp;
+	uint32_t eax;
+	uint32_t ds;
+	uint32_t es;
+	uint32_t fs;
+	uint32_t signum; // signal being delivered, in place of an IRQ or exception number
+	uint32_t eip;
+	uint32_t cs;
+	uint32_t eflags;
+	uint32_t esp;
+	uint32_t ss;
+} sig_context_t;
+
+// Pushed on the user stack to run a handler. It returns into code, which calls sigreturn
+typedef struct sig_frame {
+	uint32_t ret_addr; // address of code
+	uint32_t signum; // the handler's argument
+	sig_context_t context;
+	uint8_t code[SIGRETURN_CODE_SIZE];
+} sig_frame_t;
+
+struct pcb_t;
+
+extern void signal_raise (struct pcb_t * pcb, int32_t signum);
+extern int32_t signal_fatal (struct pcb_t * pcb);
+extern int32_t signal_pending ();
+extern void signal_tick ();
+extern int32_t signal_exception (int_frame_t * frame, int32_t signum);
+extern void do_signal (int_frame_t * frame);
+
+#endif
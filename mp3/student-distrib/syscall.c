@@ -9,19 +9,25 @@
 #include "types.h"
 #include "i8259.h"
 #include "scheduling.h"
-
-#define USER_VMEM (FOUR_MI_B * 32)
+#include "syscall_linkage.h"
+#include "usercopy.h"
+#include "pipe.h"
+#include "signal.h"
 
 int process_count = -1; // number of active processes
+int demand_load = 1; // load program pages on first access instead of copying the whole image
 int current_terminal = 0; // currently visible terminal
 
-// Stores the PID of the top process in each terminal
-// Each terminal's process number starts at its terminal number - 3. Each process on top of another process has that process's PID + 3.
-// So, the PID of a process % 3 will always be its terminal number.
-int terminal_processes[3] = {-3, -2, -1}; 
+// Stores the PID of the top process in each terminal, -1 if the terminal has none
+int terminal_processes[3] = {-1, -1, -1};
 // flag to track if swapping off of an execute
 int swap_flag = -1;
 int halt_flag;
+// process that halted, freed by execute once nothing runs on its kernel stack. Only set with interrupts off
+static pcb_t * halted_pcb = NULL;
+static uint32_t load_max_gap = 0; // longest TSC gap between PIT interrupts seen across a program load
+
+static int32_t file_release (int32_t fd);
 
 // back buffers for terminal data
 char key_bufs[3][BUF_LIMIT];
@@ -104,29 +110,127 @@ void swap_terminal (int terminal) {
 	
 }
 
+/*
+ * program_load
+ *   DESCRIPTION: Sets up a process's user memory and loads a program image into it, either
+ *                eagerly or by demand paging depending on demand_load
+ *   INPUTS: pcb - process to load into
+ *           inode - inode of the program image
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 on failure, otherwise the size of the program image
+ *   SIDE EFFECTS: Modifies paging, maps the process's user memory
+ */
+int32_t program_load (pcb_t * pcb, uint32_t inode) {
+	int32_t length;
+
+	length = inode_length(inode);
+	if (length == -1) {
+		return -1;
+	}
+
+	user_paging_init(pcb);
+
+	if (demand_load) {
+		if (user_paging_lazy(pcb, inode, length) == -1) {
+			return -1;
+		}
+		process_paging(pcb);
+		return length;
+	}
+
+	process_paging(pcb);
+
+	// read as many bytes as possible to the program's load address
+	return read_data(inode, 0, (uint8_t *) PROGRAM_VADDR, length);
+}
+
+/*
+ * init_sysenter
+ *   DESCRIPTION: Sets up the SYSENTER fast system call path. The kernel stack MSR points
+ *                at tss.esp0 rather than at a stack, so switching processes never has to
+ *                rewrite it; sysenter_handler loads the real stack from there
+ *   INPUTS: none
+ *	 OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+void init_sysenter (void){
+	wrmsr(IA32_SYSENTER_CS, KERNEL_CS);
+	wrmsr(IA32_SYSENTER_ESP, (uint32_t) &tss.esp0);
+	wrmsr(IA32_SYSENTER_EIP, (uint32_t) sysenter_handler);
+}
+
 /*
  * halt_syscall
- *   DESCRIPTION: Restores state to before program was executed.
+ *   DESCRIPTION: Ends the calling program
  *   INPUTS: status - value to return to parent program
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: Jumps into execute
+ *   SIDE EFFECTS: Jumps into execute, or switches to another process
  */
 int32_t halt_syscall (uint8_t status) {
+	return process_halt(status);
+}
+
+/*
+ * process_halt
+ *   DESCRIPTION: Restores state to before program was executed. A program started by
+ *                spawn instead becomes a zombie until its parent waits for it
+ *   INPUTS: status - value to return to parent program, HALT_EXCEPTION for one killed by
+ *                    an exception or signal
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Jumps into execute, or switches to another process
+ */
+int32_t process_halt (uint32_t status) {
 	int i;
 	pcb_t * pcb = get_pcb();
 	pcb_t * parent = pcb->parent;
+	pcb_t * child;
+	pcb_t * next;
 	
 	// decrement tracker
 	process_count--;
 	
-	// close files
+	// close files, std io too since it may be a pipe
 	for (i = 0; i < FARRAY_SIZE; i++) {
-		close_syscall(i);
+		file_release(i);
 	}
 
+	// children outlive this process, and nothing is left to wait for the ones that halted
+	cli();
+	while ((child = pcb->children) != NULL) {
+		pcb_remove_child(pcb, child);
+		if (child->state == PROC_ZOMBIE) {
+			pcb_free(child);
+		}
+	}
+	sti();
 
-	if(parent != NULL)
+	// user memory, page tables and the kernel stack are freed with the pcb, once off this stack
+
+	if (pcb->background)
+	{
+		// reset file array
+		init_farray(pcb);
+
+		// leave for wait, or for the scheduler if orphaned, and never run again
+		cli();
+		pcb->exit_status = status;
+		pcb->state = PROC_ZOMBIE;
+		if (parent != NULL) {
+			wake_up_all(&(parent->child_exit));
+		}
+		next = next_task();
+		if (next != NULL) {
+			switch_task(next->pid);
+		}
+
+		// nothing else can run yet
+		while (1) {
+			idle();
+		}
+	}
+	else if(parent != NULL)
 	{
 		// reset file array
 		init_farray(pcb);
@@ -134,15 +238,20 @@ int32_t halt_syscall (uint8_t status) {
 		// update process tracker
 		terminal_processes[parent->terminal] = parent->pid;
 		// restore parent paging to 128MB
-		page_on_4mb ((void*) (FOUR_MI_B * 2 + (terminal_processes[parent->terminal] + 1) * FOUR_MI_B), (void*) (USER_VMEM));
+		process_paging (parent);
 
 		// set up TSS entry
-		tss.esp0 = (FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (terminal_processes[parent->terminal])) - 4;
-		parent->child = NULL;
+		tss.esp0 = KSTACK_TOP(parent);
+
+		// execute frees this pcb after the jump
+		cli();
+		pcb_remove_child(parent, pcb);
+		parent->state = PROC_RUNNABLE;
+		halted_pcb = pcb;
 
 		// Assembly for return to execute.
 		// Restore execute's ESP and EBP from pcb and jump into execute
-		asm volatile("movzx %0, %%eax	#zero-extend return value \n\
+		asm volatile("movl %0, %%eax	# return value \n\
 			movl %1, %%esp \n\
 			movl %2, %%ebp \n\
 			jmp exec_return \n\
@@ -159,10 +268,14 @@ int32_t halt_syscall (uint8_t status) {
 		init_farray(pcb);
 
 		// update process tracker
-		terminal_processes[pcb->terminal] = -3 + pcb->terminal;
-		sti();
-		// start a new shell
+		terminal_processes[pcb->terminal] = -1;
+
+		// start a new shell, which frees this pcb before entering user mode
+		cli();
+		halted_pcb = pcb;
 		execute_syscall((uint8_t*) "shell");
+		halted_pcb = NULL;
+		sti();
 	}
 
 
@@ -170,28 +283,25 @@ int32_t halt_syscall (uint8_t status) {
 }
 
 /*
- * execute_syscall
- *   DESCRIPTION: Executes a program in the file system
+ * process_create
+ *   DESCRIPTION: Loads a program into a new process, ready for execute or spawn to start
  *   INPUTS: command - a space-divided string containing the name of program and arguments
- *   OUTPUTS: none
- *   RETURN VALUE: Return value of the executed process
- *   SIDE EFFECTS: Modifies stack and paging states, goes to user mode
+ *           parent - process starting it, NULL for a terminal's base shell
+ *   OUTPUTS: eip - entry point of the program
+ *   RETURN VALUE: the new process, not yet runnable, NULL on failure
+ *   SIDE EFFECTS: Maps the new process's user memory
  */
-int32_t execute_syscall (const uint8_t* command){
-	int i;
-	int ret;
+static pcb_t * process_create (const uint8_t* command, pcb_t* parent, void** eip){
+	int32_t ret;
+	uint32_t gap; // pit_max_gap from before the load
 	dentry_t dentry;
 	uint8_t buf[28]; // buffer of 28 characters of program data
 	char _command[ARG_LIMIT];
 	uint8_t args[ARG_LIMIT];
 	pcb_t* new_pcb;
-	void * prgm_eip;
-	void * new_esp;
-	void * new_ebp;
-	int new_pid;
 
 	if (command == NULL) {
-		return -1;
+		return NULL;
 	}
 
 	// load program image into memory
@@ -203,13 +313,13 @@ int32_t execute_syscall (const uint8_t* command){
 	// If file does not exist
 	if (ret == -1)
 	{
-		return -1;
+		return NULL;
 	}
 
 	// If file is not a "normal" file (type 2)
 	if (dentry.file_type != 2)
 	{
-		return -1;
+		return NULL;
 	}
 
 	// read 28 bytes from file (EIP is at byte 24:27)
@@ -217,59 +327,92 @@ int32_t execute_syscall (const uint8_t* command){
 	// file is smaller than executable
 	if (ret != 28)
 	{
-		return -1;
+		return NULL;
 	}
 
 	// executable check magic numbers
 	if(buf[0] != 0x7f || buf[1] != 0x45 || buf[2] != 0x4c || buf[3] != 0x46)
 	{
-		return -1;
+		return NULL;
 	}
 
-	// maintain 6 process limit, because we only want 4 max per terminal, checking if that terminals pid is greater than 8 will prevent 5th program from launching
-	if (process_count >= 5 || terminal_processes[current_terminal] >= 8) {
-		printf("Program limit reached. \n");
-		return 0;
+	// allocate a pid, and a pcb and kernel stack from the frame pool
+	new_pcb = pcb_alloc();
+	if (new_pcb == NULL) {
+		printf("Out of memory for processes. \n");
+		return NULL;
 	}
 
-	// increment current process
-	new_pid = terminal_processes[current_terminal] + 3;
-
 	// set up page table
-	// remap 128 MB in virtual memory to new process, 8MB + process number * 4MB
-	page_on_4mb ((void*) (FOUR_MI_B * 2 + (new_pid + 1) * FOUR_MI_B), (void*) (USER_VMEM));
-
-	// attempt to program image to the newly mapped 128MB at offset x48000
-	i = program_imgcpy((uint8_t*) _command, (void*) (FOUR_MI_B * 32 + 0x48000));
+	// remap 128 MB in virtual memory to the new process's page table
+	// and load the program image at offset x48000, timing PIT interrupts across the copy
+	gap = pit_max_gap;
+	pit_max_gap = 0;
+	ret = program_load(new_pcb, dentry.inode_num);
+	if (pit_max_gap > load_max_gap) {
+		load_max_gap = pit_max_gap;
+	}
+	if (gap > pit_max_gap) {
+		pit_max_gap = gap;
+	}
 
 	// failed to copy program image
-	if (i == -1) {
-		// shell failed to execute we're doomed
-		if (new_pid == -1) {
-			return -1;
-		}
+	if (ret == -1) {
+		pcb_free(new_pcb);
 
-		// remap 128 MB in virtual memory to parent memory, 8MB + process number * 4MB
-		page_on_4mb ((void*) (FOUR_MI_B * 2 + (terminal_processes[current_terminal] + 1) * FOUR_MI_B), (void*) (USER_VMEM));
-		return -1;
+		// remap 128 MB in virtual memory to the caller's memory
+		process_paging (current_process());
+		return NULL;
 	}
 
-	// allocate a pcb at 8MB - 8kb * (process number)
-	new_pcb = (pcb_t*) ((FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (new_pid + 1)));
-	
-	// populate pcb with default values
-	clean_pcb (new_pcb);
-
-	// allocate pid
-	new_pcb->pid = new_pid;
-	new_pcb->child = NULL;
-
-	// initialize file array
-	init_farray(new_pcb);
+	// initialize file array, passing on the parent's open files
+	if (parent != NULL) {
+		inherit_farray(new_pcb, parent);
+	} else {
+		init_farray(new_pcb);
+	}
 	
 	// copy args
 	memcpy(new_pcb->args, args, ARG_LIMIT);
 
+	// update parent pcb and terminal value
+	if (parent != NULL) {
+		pcb_add_child(parent, new_pcb);
+		new_pcb->terminal = parent->terminal;
+	} else {
+		new_pcb->parent = NULL;
+		new_pcb->terminal = current_terminal;
+	}
+
+	process_count++;
+
+	// Extract entry point from bytes [24:27] of program data
+	*eip = (void *) (((0xFF & buf[27]) << 24) | ((0xFF & buf[26]) << 16) | ((0xFF & buf[25]) << 8) | (buf[24] & 0xFF));
+	return new_pcb;
+}
+
+/*
+ * execute_program
+ *   DESCRIPTION: Runs a program in the file system in the foreground. The parent does not
+ *                run again until it halts
+ *   INPUTS: command - a space-divided string containing the name of program and arguments
+ *           parent - process running it, NULL for a terminal's base shell
+ *   OUTPUTS: none
+ *   RETURN VALUE: Return value of the executed process, -1 if it could not start
+ *   SIDE EFFECTS: Modifies stack and paging states, goes to user mode
+ */
+static int32_t execute_program (const uint8_t* command, pcb_t* parent){
+	int ret;
+	pcb_t* new_pcb;
+	void * prgm_eip;
+	void * new_esp;
+	void * new_ebp;
+
+	new_pcb = process_create(command, parent, &prgm_eip);
+	if (new_pcb == NULL) {
+		return -1;
+	}
+
 	// store ESP and EBP
 	asm volatile(
 	    "movl %%esp, %0       # store old stack pointer \n\
@@ -278,29 +421,16 @@ int32_t execute_syscall (const uint8_t* command){
 	    : "=m" (new_pcb->parent_esp), "=m" (new_pcb->parent_ebp)
 	);
 
-	// update parent pcb and terminal value
-	if (terminal_processes[current_terminal] >= 0) {
-		new_pcb->parent = (pcb_t *) ((FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (terminal_processes[current_terminal] + 1)));
-		new_pcb->parent->child = new_pcb;
-		new_pcb->terminal = new_pcb->parent->terminal;
-	} else {
-		new_pcb->parent = NULL;
-		new_pcb->terminal = current_terminal;
-	}
-
 	// update process tracker
-	terminal_processes[new_pcb->terminal] = new_pid;
-	process_count++;
+	terminal_processes[new_pcb->terminal] = new_pcb->pid;
 
 	// set up TSS entry
 	tss.ss0 = KERNEL_DS;
-	tss.esp0 = (FOUR_MI_B * 2) - ((FOUR_KI_B * 2) * (terminal_processes[new_pcb->terminal])) - 4;
+	tss.esp0 = KSTACK_TOP(new_pcb);
 
 	// Create new stack pointer at bottom of block starting at 128MB ((4MB * 32) + 4MB - 4)
     new_esp = (void *) (USER_VMEM + FOUR_MI_B) - 4;
 	new_ebp = (void *) (USER_VMEM + FOUR_MI_B) - 4;
-	// Extract entry point from bytes [24:27] of program data
-	prgm_eip = (void *) (((0xFF & buf[27]) << 24) | ((0xFF & buf[26]) << 16) | ((0xFF & buf[25]) << 8) | (buf[24] & 0xFF));
 
 	new_pcb->esp = (uint32_t) new_esp;
 	new_pcb->ebp = (uint32_t) new_ebp;
@@ -321,10 +451,22 @@ int32_t execute_syscall (const uint8_t* command){
 	    send_eoi(KEYBOARD_IRQ_NUM);
 	}
 
+	// a halted shell restarted from its own kernel stack, which is not used past the iret
+	cli();
+	if (halted_pcb != NULL) {
+		pcb_free(halted_pcb);
+		halted_pcb = NULL;
+	}
+
+	// the scheduler runs the child in the parent's place
+	if (parent != NULL) {
+		parent->state = PROC_BLOCKED;
+	}
+	new_pcb->state = PROC_RUNNABLE;
+
 	// push iret context and iret into process
 	asm volatile(
-		"cli \n\
-		movw %0, %%ax			\n\
+		"movw %0, %%ax			\n\
 		movw %%ax, %%ds			\n\
 		pushl %0		# push USER_DS		\n\
 		pushl %1		# push new ESP \n\
@@ -345,16 +487,159 @@ int32_t execute_syscall (const uint8_t* command){
     asm volatile(
 		"exec_return: \n\
 		movl %%eax, %0			\n\
-		sti \n\
 		"
 	 : "=r" (ret)
 	 : // No Input
 	 );
 
+	// back on this process's stack, so the child that halted can go
+	pcb_free(halted_pcb);
+	halted_pcb = NULL;
+	sti();
+
 
 	return ret;
 }
 
+/*
+ * execute_syscall
+ *   DESCRIPTION: Starts a terminal's base shell, or another program with no parent
+ *   INPUTS: command - a space-divided string containing the name of program and arguments
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if the program could not start, otherwise does not return
+ *   SIDE EFFECTS: Modifies stack and paging states, goes to user mode
+ */
+int32_t execute_syscall (const uint8_t* command){
+	return execute_program(command, NULL);
+}
+
+/*
+ * execute_user_syscall
+ *   DESCRIPTION: System call entry for execute. Copies the command out of user memory,
+ *                since the kernel also calls execute_syscall with its own strings
+ *   INPUTS: command - a space-divided string containing the name of program and arguments
+ *   OUTPUTS: none
+ *   RETURN VALUE: Return value of the executed process, -1 on failure
+ */
+int32_t execute_user_syscall (const uint8_t* command){
+	uint8_t _command[ARG_LIMIT];
+
+	if (strncpy_from_user(_command, command, sizeof(_command)) == -1) {
+		return -1;
+	}
+
+	return execute_program(_command, get_pcb());
+}
+
+/*
+ * spawn_syscall
+ *   DESCRIPTION: Starts a program alongside the caller instead of in its place. The caller
+ *                keeps running, and reaps the child with wait once it halts
+ *   INPUTS: command - a space-divided string containing the name of program and arguments
+ *   OUTPUTS: none
+ *   RETURN VALUE: pid of the child, -1 on failure
+ *   SIDE EFFECTS: Makes the child runnable
+ */
+int32_t spawn_syscall (const uint8_t* command){
+	uint8_t _command[ARG_LIMIT];
+	pcb_t* pcb = get_pcb();
+	pcb_t* child;
+	void* prgm_eip;
+	uint32_t* stack;
+
+	if (strncpy_from_user(_command, command, sizeof(_command)) == -1) {
+		return -1;
+	}
+
+	child = process_create(_command, pcb, &prgm_eip);
+	if (child == NULL) {
+		return -1;
+	}
+	child->background = 1;
+
+	// loading mapped the child, map the caller again
+	process_paging(pcb);
+
+	// switch_task resumes a process by loading its esp and ebp and returning. Give the
+	// child a frame to return through into spawn_return, which irets to the program
+	stack = (uint32_t*) KSTACK_TOP(child);
+	*(stack--) = USER_DS;
+	*(stack--) = USER_VMEM + FOUR_MI_B - 4; // user esp
+	*(stack--) = 0x202; // flags, with interrupts on
+	*(stack--) = USER_CS;
+	*(stack--) = (uint32_t) prgm_eip;
+	*(stack--) = (uint32_t) spawn_return;
+	*stack = 0; // ebp of the frame being returned from
+	child->esp = (uint32_t) stack;
+	child->ebp = (uint32_t) stack;
+
+	child->state = PROC_RUNNABLE;
+	return child->pid;
+}
+
+/*
+ * wait_syscall
+ *   DESCRIPTION: Reaps a child started by spawn once it halts
+ *   INPUTS: pid - child to wait for, -1 for any
+ *           flags - WAIT_NOHANG to return at once if no child has halted
+ *   OUTPUTS: status - the child's halt status, unless NULL
+ *   RETURN VALUE: pid of the reaped child, 0 if WAIT_NOHANG and none has halted, -1 if
+ *                 there is no such child or a signal is about to kill the program
+ *   SIDE EFFECTS: Frees the child
+ */
+int32_t wait_syscall (int32_t pid, int32_t* status, int32_t flags){
+	pcb_t* pcb = get_pcb();
+	pcb_t* child;
+	int32_t found;
+	int32_t reaped;
+	int32_t child_status;
+
+	// check where the status goes before reaping anything
+	if (status != NULL && user_range(status, sizeof(*status), 1) == -1) {
+		return -1;
+	}
+
+	while (1) {
+		found = 0;
+		reaped = 0;
+
+		cli();
+		for (child = pcb->children; child != NULL; child = child->sibling) {
+			if (!child->background || (pid != -1 && child->pid != pid)) {
+				continue;
+			}
+			found = 1;
+			if (child->state == PROC_ZOMBIE) {
+				reaped = child->pid;
+				child_status = child->exit_status;
+				pcb_remove_child(pcb, child);
+				pcb_free(child);
+				break;
+			}
+		}
+
+		if (reaped != 0) {
+			sti();
+			if (status != NULL && copy_to_user(status, &child_status, sizeof(child_status)) == -1) {
+				return -1;
+			}
+			return reaped;
+		}
+
+		if (!found || signal_fatal(pcb)) {
+			sti();
+			return -1;
+		}
+		if (flags & WAIT_NOHANG) {
+			sti();
+			return 0;
+		}
+
+		// off the run set until a child halts
+		wait_sleep(&(pcb->child_exit));
+	}
+}
+
 /*
  * read_syscall
  *   DESCRIPTION: Read from a desired file
@@ -367,9 +652,8 @@ int32_t read_syscall (int32_t fd, void* buf, int32_t nbytes){
 	int ret;
 	pcb_t* pcb = get_pcb();
 
-	// if the argument location is not within the user memory
-	// 128 MB to 132 MB (4MB * 32 to 4MB * 33)
-	if ((uint32_t) buf < (USER_VMEM) || (uint32_t) buf >= (USER_VMEM + FOUR_MI_B)) {
+	// the whole buffer has to be within the user memory
+	if (nbytes < 0 || user_range(buf, nbytes, 1) == -1) {
 		return -1;
 	}
 
@@ -411,9 +695,8 @@ int32_t write_syscall (int32_t fd, const void* buf, int32_t nbytes){
 	int ret;
 	pcb_t* pcb = get_pcb();
 
-	// if the argument location is not within the user memory
-	// 128 MB to 132 MB (4MB * 32 to 4MB * 33)
-	if ((uint32_t) buf < (USER_VMEM) || (uint32_t) buf >= (USER_VMEM + FOUR_MI_B)) {
+	// the whole buffer has to be within the user memory or the mapped mmap window
+	if (nbytes < 0 || user_range(buf, nbytes, 0) == -1) {
 		return -1;
 	}
 
@@ -450,28 +733,29 @@ int32_t write_syscall (int32_t fd, const void* buf, int32_t nbytes){
  *   SIDE EFFECTS: Modifies file array
  */
 int32_t open_syscall (const uint8_t* filename){
+	uint8_t name[FNAME_MAX_LEN + 2]; // room to tell a 32 character name from a longer one
+
+	if (strncpy_from_user(name, filename, sizeof(name)) == -1) {
+		return -1;
+	}
+
 	// all files have unknown type until opened and assigned a file descriptor in open
 	// file_open works for every file type
-	return file_open(filename);
+	return file_open(name);
 }
 
 /*
- * close_syscall
- *   DESCRIPTION: Closes a file
+ * file_release
+ *   DESCRIPTION: Closes any open file descriptor, std io included
  *   INPUTS: fd - file descriptor of the file
  *   OUTPUTS: none
  *   RETURN VALUE: 0 on success, -1 on failure
  *   SIDE EFFECTS: Modifies file array
  */
-int32_t close_syscall (int32_t fd){
+static int32_t file_release (int32_t fd){
 	int ret;
 	pcb_t* pcb = get_pcb();
 
-	// Validity of fd. fd 0,1 are std io and should not be closed
-	if (fd < 2 || fd >= FARRAY_SIZE) {
-		return -1;
-	}
-
 	// fail if file is not open
 	if (pcb->file_array[fd].flags == 0) {
 		return -1;
@@ -495,10 +779,31 @@ int32_t close_syscall (int32_t fd){
 	pcb->file_array[fd].inode_num = 0;
 	pcb->file_array[fd].file_pos = 0;
 	pcb->file_array[fd].flags = 0;
+	pcb->file_array[fd].inode = NULL;
+	pcb->file_array[fd].block_index = 0;
+	pcb->file_array[fd].block_addr = NULL;
+	pcb->file_array[fd].pipe = NULL;
 
 	return ret;
 }
 
+/*
+ * close_syscall
+ *   DESCRIPTION: Closes a file
+ *   INPUTS: fd - file descriptor of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 on success, -1 on failure
+ *   SIDE EFFECTS: Modifies file array
+ */
+int32_t close_syscall (int32_t fd){
+	// Validity of fd. fd 0,1 are std io and should not be closed
+	if (fd < 2 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	return file_release(fd);
+}
+
 /*
  * getargs_syscall
  *   DESCRIPTION: Copies arguments into a given buffer
@@ -507,21 +812,14 @@ int32_t close_syscall (int32_t fd){
  *   RETURN VALUE: -1 on failure, otherwise 0
  */
 int32_t getargs_syscall (uint8_t* buf, int32_t nbytes){
-	if(buf == NULL)
+	if(buf == NULL || nbytes < 0)
 		return -1;
 
-	// if the argument location is not within the user memory
-	// 128 MB to 132 MB (4MB * 32 to 4MB * 33)
-	if ((uint32_t) buf < (USER_VMEM) || (uint32_t) buf >= (USER_VMEM + FOUR_MI_B)) {
-		return -1;
-	}
-
 	pcb_t* pcb = get_pcb();
 	if(pcb->args[0] != '\0')
 	{
 		// write desired data from pcb
-		memcpy(buf, pcb->args, (nbytes > ARG_LIMIT ? ARG_LIMIT : nbytes));
-		return 0;
+		return copy_to_user(buf, pcb->args, (nbytes > ARG_LIMIT ? ARG_LIMIT : nbytes));
 	}
 
 	return -1;
@@ -542,36 +840,604 @@ int32_t vidmap_syscall (uint8_t** screen_start){
 		return -1;
 	}
 
-	// if the argument location is not within the user memory
-	// 128 MB to 132 MB (4MB * 32 to 4MB * 33)
-	if ((uint32_t) screen_start < (USER_VMEM) || (uint32_t) screen_start >= (USER_VMEM + FOUR_MI_B)) {
-		return -1;
-	}
-
 	// put address into arg
-	*screen_start = map_loc;
-
-	return 0;
+	return copy_to_user(screen_start, &map_loc, sizeof(map_loc));
 }
 
 /*
  * set_handler_syscall
- *   DESCRIPTION: Does nothing
- *   INPUTS: ignored
+ *   DESCRIPTION: Sets the user function a signal runs, or restores its default action
+ *   INPUTS: signum - signal number
+ *           handler - function taking the signal number, NULL for the default action
  *	 OUTPUTS: none
- *   RETURN VALUE: -1
+ *   RETURN VALUE: 0 on success, -1 on failure
  */
 int32_t set_handler_syscall (int32_t signum, void* handler){
-	return -1;
+	if (signum < 0 || signum >= NUM_SIGNALS) {
+		return -1;
+	}
+
+	// the handler has to be in user memory
+	if (handler != NULL && user_range(handler, 1, 0) == -1) {
+		return -1;
+	}
+
+	get_pcb()->sig_handlers[signum] = handler;
+	return 0;
 }
 
 /*
  * sigreturn_syscall
- *   DESCRIPTION: Does nothing
- *   INPUTS: ignored
+ *   DESCRIPTION: Returns from a signal handler to where the signal interrupted the program,
+ *                restoring the hardware context saved in the signal frame. Only reached
+ *                through INT 0x80, from the code the frame returns into
+ *   INPUTS: none
  *	 OUTPUTS: none
- *   RETURN VALUE: -1
+ *   RETURN VALUE: the saved EAX, which the linkage restores as the return value, -1 on failure
+ *   SIDE EFFECTS: Unmasks signals
  */
 int32_t sigreturn_syscall (void){
-	return -1;
+	pcb_t* pcb = get_pcb();
+	int_frame_t* frame = (int_frame_t*) (KSTACK_TOP(pcb) - sizeof(int_frame_t));
+	sig_context_t context;
+
+	// the INT 0x80 frame at the top of the kernel stack has to be from user mode
+	if (frame->cs != USER_CS) {
+		return -1;
+	}
+
+	// the handler returned past its own address, leaving the signal number on top
+	if (copy_from_user(&context, (void*) (frame->user_esp + sizeof(uint32_t)), sizeof(context)) == -1) {
+		return -1;
+	}
+
+	frame->ebx = context.ebx;
+	frame->ecx = context.ecx;
+	frame->edx = context.edx;
+	frame->esi = context.esi;
+	frame->edi = context.edi;
+	frame->ebp = context.ebp;
+	frame->eip = context.eip;
+	frame->eflags = (frame->eflags & ~EFLAGS_USER) | (context.eflags & EFLAGS_USER);
+	frame->user_esp = context.esp;
+	pcb->sig_masked = 0;
+
+	return context.eax;
+}
+
+/*
+ * alarm_syscall
+ *   DESCRIPTION: Sets how often the PIT sends the caller ALARM, starting a new period now
+ *   INPUTS: ms - milliseconds between alarms, rounded up to whole PIT ticks, 0 for none
+ *	 OUTPUTS: none
+ *   RETURN VALUE: 0 on success, -1 on failure
+ */
+int32_t alarm_syscall (int32_t ms){
+	pcb_t* pcb = get_pcb();
+	uint32_t tick = 1000 / PIT_FREQ;
+
+	if (ms < 0) {
+		return -1;
+	}
+
+	cli();
+	pcb->alarm_period = (ms + tick - 1) / tick * tick;
+	pcb->alarm_left = pcb->alarm_period;
+	sti();
+	return 0;
+}
+
+/*
+ * sleep_wake
+ *   DESCRIPTION: Timer callback that puts a sleeping process back on the run set
+ *   INPUTS: timer - the process's sleep_timer
+ *	 OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+static void sleep_wake (ktimer_t* timer){
+	((pcb_t*) timer->data)->state = PROC_RUNNABLE;
+}
+
+/*
+ * sleep_syscall
+ *   DESCRIPTION: Takes the caller off the run set until a timer wakes it, so it uses no CPU
+ *                while it sleeps. A signal that has a handler or kills wakes it early
+ *   INPUTS: ms - milliseconds to sleep, rounded up to whole PIT ticks
+ *	 OUTPUTS: none
+ *   RETURN VALUE: 0 after sleeping the whole time, -1 on failure or if a signal woke it
+ */
+int32_t sleep_syscall (int32_t ms){
+	pcb_t* pcb = get_pcb();
+	uint32_t tick = 1000 / PIT_FREQ;
+
+	if (ms < 0) {
+		return -1;
+	}
+	if (ms == 0) {
+		return 0;
+	}
+
+	cli();
+	timer_add(&(pcb->sleep_timer), (ms + tick - 1) / tick, sleep_wake, pcb);
+	pcb->state = PROC_BLOCKED;
+	block();
+
+	// the timer keeps its deadline when a signal cancels it
+	return ((int32_t) (pit_ticks - pcb->sleep_timer.expires) < 0) ? -1 : 0;
+}
+
+/*
+ * cpustat_syscall
+ *   DESCRIPTION: Reports how many PIT ticks have passed and how many of them the CPU spent
+ *                in the idle context, for measuring utilization between two calls, and the
+ *                worst interrupt latency seen since the previous call, overall and across
+ *                program loads
+ *   INPUTS: none
+ *	 OUTPUTS: buf - tick counts since boot
+ *   RETURN VALUE: 0 on success, -1 on failure
+ *   SIDE EFFECTS: Restarts the PIT gap measurement
+ */
+int32_t cpustat_syscall (cpustat_t* buf){
+	cpustat_t stat;
+
+	cli();
+	stat.ticks = pit_ticks;
+	stat.idle_ticks = idle_ticks;
+	stat.max_gap = pit_max_gap;
+	stat.load_max_gap = load_max_gap;
+	pit_max_gap = 0;
+	load_max_gap = 0;
+	sti();
+
+	return copy_to_user(buf, &stat, sizeof(stat));
+}
+
+/*
+ * mmap_syscall
+ *   DESCRIPTION: Maps an open file read-only into the caller's mmap window. Data blocks are
+ *                mapped straight out of the file system module when page aligned, otherwise
+ *                (or when the file is compressed) they are read into freshly allocated frames.
+ *   INPUTS: fd - file descriptor of an open normal file
+ *	 OUTPUTS: start - address to write the start of the mapping to
+ *   RETURN VALUE: length of the file in bytes, -1 on failure
+ *   SIDE EFFECTS: Modifies the process's mmap page table
+ */
+int32_t mmap_syscall (int32_t fd, uint8_t** start){
+	int i;
+	int32_t length;
+	int32_t copied;
+	uint32_t pages;
+	uint8_t* block;
+	void* frame;
+	pcb_t* pcb = get_pcb();
+
+	if (start == NULL) {
+		return -1;
+	}
+
+	// check where the start goes before mapping anything
+	if (user_range(start, sizeof(*start), 1) == -1) {
+		return -1;
+	}
+
+	// Validity of fd
+	if (fd < 0 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	// fail if file is not open or is not a normal file
+	if (pcb->file_array[fd].flags == 0 || pcb->file_array[fd].operations_pointer == NULL
+			|| pcb->file_array[fd].operations_pointer->read_op != file_read) {
+		return -1;
+	}
+
+	length = inode_length(pcb->file_array[fd].inode_num);
+	if (length == -1) {
+		return -1;
+	}
+
+	// fail if the window is out of room
+	pages = (length + FOUR_KI_B - 1) / FOUR_KI_B;
+	if (pcb->mmap_pages + pages > PAGE_TABLE_SIZE) {
+		return -1;
+	}
+
+	for (i = 0; i < pages; i++) {
+		block = inode_block(pcb->file_array[fd].inode_num, i);
+
+		if (block != NULL && ((uint32_t) block & (FOUR_KI_B - 1)) == 0) {
+			// zero copy, map the block itself read-only
+			mmap_page(pcb, pcb->mmap_pages + i, block, PTE_USER | PTE_PRESENT);
+		} else {
+			// block straddles pages or is compressed, copy it into a frame of its own
+			frame = frame_alloc();
+			if (frame == NULL) {
+				break;
+			}
+			copied = read_data(pcb->file_array[fd].inode_num, i * FOUR_KI_B, frame, FOUR_KI_B);
+			if (copied == -1) {
+				frame_free(frame);
+				break;
+			}
+			memset((uint8_t*) frame + copied, 0, FOUR_KI_B - copied);
+			mmap_page(pcb, pcb->mmap_pages + i, frame, PTE_FRAME | PTE_USER | PTE_PRESENT);
+		}
+	}
+
+	// undo a partial mapping
+	if (i < pages) {
+		while (i-- > 0) {
+			mmap_page(pcb, pcb->mmap_pages + i, NULL, 0);
+		}
+		return -1;
+	}
+
+	// flush tlb
+	process_paging(pcb);
+
+	block = (uint8_t*) (MMAP_VMEM + pcb->mmap_pages * FOUR_KI_B);
+	pcb->mmap_pages += pages;
+
+	if (copy_to_user(start, &block, sizeof(block)) == -1) {
+		return -1;
+	}
+	return length;
+}
+
+/*
+ * getdents_syscall
+ *   DESCRIPTION: Reads a batch of directory entries as fixed-size records
+ *   INPUTS: fd - file descriptor of an open directory
+ *           nbytes - size of the buffer
+ *	 OUTPUTS: buf - buffer to fill with records
+ *   RETURN VALUE: number of bytes written, 0 at the end of the directory, -1 on failure
+ */
+int32_t getdents_syscall (int32_t fd, void* buf, int32_t nbytes){
+	// the whole buffer has to be within the user memory
+	if (nbytes < 0 || user_range(buf, nbytes, 1) == -1) {
+		return -1;
+	}
+
+	// Validity of fd
+	if (fd < 0 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	return fdir_getdents(fd, buf, nbytes);
+}
+
+/*
+ * stat_syscall
+ *   DESCRIPTION: Gets the type, length and block count of a file by name
+ *   INPUTS: filename - string containing the file name
+ *	 OUTPUTS: buf - stat struct to fill in
+ *   RETURN VALUE: 0 on success, -1 on failure
+ */
+int32_t stat_syscall (const uint8_t* filename, stat_t* buf){
+	uint8_t name[FNAME_MAX_LEN + 2]; // room to tell a 32 character name from a longer one
+	stat_t st;
+
+	if (strncpy_from_user(name, filename, sizeof(name)) == -1) {
+		return -1;
+	}
+
+	if (file_stat(name, &st) == -1) {
+		return -1;
+	}
+	return copy_to_user(buf, &st, sizeof(st));
+}
+
+/*
+ * fstat_syscall
+ *   DESCRIPTION: Gets the type, length and block count of an open file
+ *   INPUTS: fd - file descriptor of the file
+ *	 OUTPUTS: buf - stat struct to fill in
+ *   RETURN VALUE: 0 on success, -1 on failure
+ */
+int32_t fstat_syscall (int32_t fd, stat_t* buf){
+	stat_t st;
+
+	// Validity of fd
+	if (fd < 0 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	if (file_fstat(fd, &st) == -1) {
+		return -1;
+	}
+	return copy_to_user(buf, &st, sizeof(st));
+}
+
+/*
+ * lseek_syscall
+ *   DESCRIPTION: Moves the position of an open regular file
+ *   INPUTS: fd - file descriptor of the file
+ *           offset - signed byte offset
+ *           whence - SEEK_SET, SEEK_CUR or SEEK_END
+ *	 OUTPUTS: none
+ *   RETURN VALUE: new position on success, -1 on failure
+ */
+int32_t lseek_syscall (int32_t fd, int32_t offset, int32_t whence){
+	// Validity of fd
+	if (fd < 0 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	return file_lseek(fd, offset, whence);
+}
+
+/*
+ * pread_syscall
+ *   DESCRIPTION: Reads from an offset of an open regular file without moving its position
+ *   INPUTS: fd - file descriptor of the file
+ *           nbytes - number of bytes to read
+ *           offset - byte offset in the file to start at
+ *	 OUTPUTS: buf - buffer to read into
+ *   RETURN VALUE: number of bytes read, 0 at EOF, -1 on failure
+ */
+int32_t pread_syscall (int32_t fd, void* buf, int32_t nbytes, uint32_t offset){
+	// the whole buffer has to be within the user memory
+	if (nbytes < 0 || user_range(buf, nbytes, 1) == -1) {
+		return -1;
+	}
+
+	// Validity of fd
+	if (fd < 0 || fd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	return file_pread(fd, buf, nbytes, offset);
+}
+
+/*
+ * copy_iovec
+ *   DESCRIPTION: Copies a user's segment list into the kernel so it can't change while in use
+ *   INPUTS: iov - segment list in user memory
+ *           iovcnt - number of segments, at most IOV_MAX
+ *	 OUTPUTS: kiov - kernel copy of the segments
+ *   RETURN VALUE: 0 on success, -1 on failure
+ */
+static int32_t copy_iovec (iovec_t* kiov, const iovec_t* iov, int32_t iovcnt){
+	if (iovcnt <= 0 || iovcnt > IOV_MAX) {
+		return -1;
+	}
+
+	return copy_from_user(kiov, iov, iovcnt * sizeof(iovec_t));
+}
+
+/*
+ * readv_syscall
+ *   DESCRIPTION: Reads from a file into several buffers with one system call. Stops at the
+ *                first segment that isn't filled completely
+ *   INPUTS: fd - file descriptor number
+ *           iov - list of buffers to fill in order
+ *           iovcnt - number of buffers, at most IOV_MAX
+ *	 OUTPUTS: buffers in iov
+ *   RETURN VALUE: total bytes read, -1 on failure before anything was read
+ */
+int32_t readv_syscall (int32_t fd, const iovec_t* iov, int32_t iovcnt){
+	iovec_t kiov[IOV_MAX];
+	int32_t (*read_op)(uint32_t, void*, uint32_t);
+	int32_t total, ret;
+	int i;
+	pcb_t* pcb = get_pcb();
+
+	if (copy_iovec(kiov, iov, iovcnt) == -1) {
+		return -1;
+	}
+
+	// every buffer has to be within the user memory
+	for (i = 0; i < iovcnt; i++) {
+		if (kiov[i].len < 0 || user_range(kiov[i].base, kiov[i].len, 1) == -1) {
+			return -1;
+		}
+	}
+
+	// Validity of fd, and look up the operation once
+	if (fd < 0 || fd >= FARRAY_SIZE || pcb->file_array[fd].flags == 0
+			|| pcb->file_array[fd].operations_pointer == NULL
+			|| pcb->file_array[fd].operations_pointer->read_op == NULL) {
+		return -1;
+	}
+	read_op = pcb->file_array[fd].operations_pointer->read_op;
+
+	total = 0;
+	for (i = 0; i < iovcnt; i++) {
+		ret = read_op(fd, kiov[i].base, kiov[i].len);
+		if (ret == -1) {
+			return (total == 0) ? -1 : total;
+		}
+		total += ret;
+		if (ret < kiov[i].len) {
+			break;
+		}
+	}
+
+	return total;
+}
+
+/*
+ * writev_syscall
+ *   DESCRIPTION: Writes several buffers to a file with one system call
+ *   INPUTS: fd - file descriptor number
+ *           iov - list of buffers to write in order
+ *           iovcnt - number of buffers, at most IOV_MAX
+ *	 OUTPUTS: none
+ *   RETURN VALUE: total bytes written, -1 on failure before anything was written
+ */
+int32_t writev_syscall (int32_t fd, const iovec_t* iov, int32_t iovcnt){
+	iovec_t kiov[IOV_MAX];
+	int32_t (*write_op)(uint32_t, const void*, uint32_t);
+	int32_t total, ret;
+	int i;
+	pcb_t* pcb = get_pcb();
+
+	if (copy_iovec(kiov, iov, iovcnt) == -1) {
+		return -1;
+	}
+
+	// every buffer has to be within the user memory or the mapped mmap window
+	for (i = 0; i < iovcnt; i++) {
+		if (kiov[i].len < 0 || user_range(kiov[i].base, kiov[i].len, 0) == -1) {
+			return -1;
+		}
+	}
+
+	// Validity of fd, and look up the operation once
+	if (fd < 0 || fd >= FARRAY_SIZE || pcb->file_array[fd].flags == 0
+			|| pcb->file_array[fd].operations_pointer == NULL
+			|| pcb->file_array[fd].operations_pointer->write_op == NULL) {
+		return -1;
+	}
+	write_op = pcb->file_array[fd].operations_pointer->write_op;
+
+	total = 0;
+	for (i = 0; i < iovcnt; i++) {
+		ret = write_op(fd, kiov[i].base, kiov[i].len);
+		if (ret == -1) {
+			return (total == 0) ? -1 : total;
+		}
+		total += ret;
+	}
+
+	return total;
+}
+
+/*
+ * poll_syscall
+ *   DESCRIPTION: Waits until at least one of several open files is ready, asking each
+ *                file's poll_op. Sleeps a PIT tick between checks instead of spinning
+ *   INPUTS: fds - descriptors and the events to wait for
+ *           nfds - number of descriptors, at most FARRAY_SIZE
+ *           timeout - milliseconds to wait, 0 to only check, negative to wait forever
+ *	 OUTPUTS: revents of each entry in fds
+ *   RETURN VALUE: number of ready descriptors, 0 on timeout, -1 on failure
+ */
+int32_t poll_syscall (pollfd_t* fds, int32_t nfds, int32_t timeout){
+	pollfd_t kfds[FARRAY_SIZE];
+	int32_t (*poll_op[FARRAY_SIZE])(uint32_t);
+	uint32_t deadline;
+	int32_t ready, events;
+	int i;
+	pcb_t* pcb = get_pcb();
+
+	if (nfds <= 0 || nfds > FARRAY_SIZE) {
+		return -1;
+	}
+
+	if (copy_from_user(kfds, fds, nfds * sizeof(pollfd_t)) == -1) {
+		return -1;
+	}
+
+	// Validity of every fd, and look up the operations once
+	for (i = 0; i < nfds; i++) {
+		if (kfds[i].fd < 0 || kfds[i].fd >= FARRAY_SIZE || pcb->file_array[kfds[i].fd].flags == 0
+				|| pcb->file_array[kfds[i].fd].operations_pointer == NULL
+				|| pcb->file_array[kfds[i].fd].operations_pointer->poll_op == NULL) {
+			return -1;
+		}
+		poll_op[i] = pcb->file_array[kfds[i].fd].operations_pointer->poll_op;
+	}
+
+	// round the timeout up to whole PIT ticks
+	deadline = pit_ticks + ((uint32_t) timeout + (1000 / PIT_FREQ) - 1) / (1000 / PIT_FREQ);
+
+	while (1) {
+		ready = 0;
+		for (i = 0; i < nfds; i++) {
+			events = poll_op[i](kfds[i].fd) & kfds[i].events;
+			kfds[i].revents = events;
+			if (events != 0) {
+				ready++;
+			}
+		}
+
+		if (ready != 0 || timeout == 0
+				|| (timeout > 0 && (int32_t) (pit_ticks - deadline) >= 0)) {
+			if (copy_to_user(fds, kfds, nfds * sizeof(pollfd_t)) == -1) {
+				return -1;
+			}
+			return ready;
+		}
+
+		if (signal_fatal(pcb)) {
+			return -1;
+		}
+
+		// off the run set until the next tick, which may have changed something
+		cli();
+		timer_add(&(pcb->sleep_timer), 1, sleep_wake, pcb);
+		pcb->state = PROC_BLOCKED;
+		block();
+	}
+}
+
+/*
+ * pipe_syscall
+ *   DESCRIPTION: Makes a pipe. Both ends are close-on-exec; dup2 one onto std io to pass it
+ *                to a program
+ *   INPUTS: none
+ *   OUTPUTS: fds - fds[0] is the read end, fds[1] the write end
+ *   RETURN VALUE: 0 on success, -1 on failure
+ *   SIDE EFFECTS: Modifies file array
+ */
+int32_t pipe_syscall (int32_t* fds){
+	int32_t kfds[2];
+
+	// check where the descriptors go before opening anything
+	if (user_range(fds, sizeof(kfds), 1) == -1) {
+		return -1;
+	}
+
+	if (pipe_create(kfds) == -1) {
+		return -1;
+	}
+
+	if (copy_to_user(fds, kfds, sizeof(kfds)) == -1) {
+		file_release(kfds[0]);
+		file_release(kfds[1]);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * dup2_syscall
+ *   DESCRIPTION: Makes newfd a copy of oldfd, closing whatever newfd held first. Works on
+ *                std io, which is how a pipe end becomes a program's stdin or stdout. The
+ *                copy is never close-on-exec
+ *   INPUTS: oldfd - open file descriptor to copy
+ *           newfd - file descriptor to replace
+ *   OUTPUTS: none
+ *   RETURN VALUE: newfd on success, -1 on failure
+ *   SIDE EFFECTS: Modifies file array
+ */
+int32_t dup2_syscall (int32_t oldfd, int32_t newfd){
+	pcb_t* pcb = get_pcb();
+	operations_t* ops;
+
+	// Validity of both fds
+	if (oldfd < 0 || oldfd >= FARRAY_SIZE || newfd < 0 || newfd >= FARRAY_SIZE) {
+		return -1;
+	}
+
+	// fail if file is not open
+	if (pcb->file_array[oldfd].flags == 0 || pcb->file_array[oldfd].operations_pointer == NULL) {
+		return -1;
+	}
+
+	if (oldfd == newfd) {
+		return newfd;
+	}
+
+	// count the copy before closing newfd, which may hold the last other one
+	ops = pcb->file_array[oldfd].operations_pointer;
+	if (ops->dup_op != NULL && ops->dup_op(oldfd) == -1) {
+		return -1;
+	}
+	file_release(newfd);
+
+	memcpy(&(pcb->file_array[newfd]), &(pcb->file_array[oldfd]), sizeof(farray_t));
+	pcb->file_array[newfd].flags &= ~FD_CLOEXEC;
+	return newfd;
 }
@@ -1,17 +1,54 @@
 #include "types.h"
 #include "paging.h"
 #include "lib.h"
+#include "filesys.h"
 #ifndef _ASM
 #define VMEM_BUFFERS (VIDEO + FOUR_KI_B)
+#define NUM_SYSCALLS 26 // entries in syscall_jump_table, keep in step with syscall_linkage.S
+#define IOV_MAX 16 // most segments in one readv or writev
+#define WAIT_NOHANG 0x1 // wait returns 0 instead of blocking when no child has halted
+
+// Model specific registers read by SYSENTER
+#define IA32_SYSENTER_CS	0x174
+#define IA32_SYSENTER_ESP	0x175
+#define IA32_SYSENTER_EIP	0x176
+
+// One buffer of a readv or writev
+typedef struct iovec {
+	void* base;
+	int32_t len;
+} iovec_t;
+
+// One descriptor watched by poll
+typedef struct pollfd {
+	int32_t fd;
+	int16_t events; // POLLIN/POLLOUT bits to wait for
+	int16_t revents; // bits that were ready, filled in by poll
+} pollfd_t;
+
+// CPU time since boot, in PIT ticks, as returned by cpustat
+typedef struct cpustat {
+	uint32_t ticks; // all PIT interrupts
+	uint32_t idle_ticks; // the ones that found the CPU idle
+	uint32_t max_gap; // longest TSC gap between PIT interrupts since the last call
+	uint32_t load_max_gap; // the same, for gaps ending while execute or spawn loaded a program
+} cpustat_t;
 
 
 extern int current_terminal;
 extern int terminal_processes[3];
 extern uint8_t* vmem_buffers[3];
 extern uint8_t* map_loc;
+extern int demand_load;
+extern int32_t program_load (pcb_t * pcb, uint32_t inode);
 extern void swap_terminal (int terminal);
+extern void init_sysenter (void);
 extern int32_t halt_syscall (uint8_t status);
+extern int32_t process_halt (uint32_t status);
 extern int32_t execute_syscall (const uint8_t* command);
+extern int32_t execute_user_syscall (const uint8_t* command);
+extern int32_t spawn_syscall (const uint8_t* command);
+extern int32_t wait_syscall (int32_t pid, int32_t* status, int32_t flags);
 extern int32_t read_syscall (int32_t fd, void* buf, int32_t nbytes);
 extern int32_t write_syscall (int32_t fd, const void* buf, int32_t nbytes);
 extern int32_t open_syscall (const uint8_t* filename);
@@ -20,4 +57,18 @@ extern int32_t getargs_syscall (uint8_t* buf, int32_t nbytes);
 extern int32_t vidmap_syscall (uint8_t** screen_start);
 extern int32_t set_handler_syscall (int32_t signum, void* handler);
 extern int32_t sigreturn_syscall (void);
+extern int32_t mmap_syscall (int32_t fd, uint8_t** start);
+extern int32_t getdents_syscall (int32_t fd, void* buf, int32_t nbytes);
+extern int32_t stat_syscall (const uint8_t* filename, stat_t* buf);
+extern int32_t fstat_syscall (int32_t fd, stat_t* buf);
+extern int32_t lseek_syscall (int32_t fd, int32_t offset, int32_t whence);
+extern int32_t pread_syscall (int32_t fd, void* buf, int32_t nbytes, uint32_t offset);
+extern int32_t readv_syscall (int32_t fd, const iovec_t* iov, int32_t iovcnt);
+extern int32_t writev_syscall (int32_t fd, const iovec_t* iov, int32_t iovcnt);
+extern int32_t poll_syscall (pollfd_t* fds, int32_t nfds, int32_t timeout);
+extern int32_t pipe_syscall (int32_t* fds);
+extern int32_t dup2_syscall (int32_t oldfd, int32_t newfd);
+extern int32_t alarm_syscall (int32_t ms);
+extern int32_t sleep_syscall (int32_t ms);
+extern int32_t cpustat_syscall (cpustat_t* buf);
 #endif
@@ -7,4 +7,6 @@
 #include "types.h"
 
 extern int32_t system_call_handler();
+extern void sysenter_handler();
+extern void spawn_return();
 #endif
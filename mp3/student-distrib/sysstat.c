@@ -0,0 +1,172 @@
+#include "sysstat.h"
+#include "syscall.h"
+#include "pcb.h"
+#include "scheduling.h"
+#include "lib.h"
+
+// Handlers in syscall_linkage.S, ordered by number
+extern int32_t (*syscall_jump_table[NUM_SYSCALLS])(uint32_t, uint32_t, uint32_t, uint32_t);
+
+// Statistics per pid and system call, row 0 for everything no longer in a row of its own
+static sysstat_t sysstats[SYSSTAT_PIDS][NUM_SYSCALLS];
+// pit_ticks when the process in each row was created
+static uint32_t sysstat_start[SYSSTAT_PIDS];
+
+/*
+ * latency_bucket
+ *   DESCRIPTION: Finds the log2 histogram bucket for a call's duration
+ *   INPUTS: cycles - TSC cycles the call took
+ *   OUTPUTS: none
+ *   RETURN VALUE: floor(log2(cycles)), capped to the last bucket
+ */
+static uint32_t latency_bucket (uint64_t cycles) {
+	uint32_t hi = (uint32_t) (cycles >> 32);
+	uint32_t lo = (uint32_t) cycles;
+	uint32_t bit;
+
+	if (hi != 0 || lo == 0) {
+		return (hi != 0) ? SYSSTAT_BUCKETS - 1 : 0;
+	}
+	asm ("bsrl %1, %0" : "=r" (bit) : "r" (lo));
+	return bit;
+}
+
+/*
+ * sysstat_reset
+ *   DESCRIPTION: Starts a fresh row for a new process, folding what the pid's previous
+ *                process did into row 0 so nothing is counted twice or lost
+ *   INPUTS: pid - pid just given to a new process
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+void sysstat_reset (uint32_t pid) {
+	uint32_t i, j;
+	uint32_t flags;
+
+	if (pid == 0 || pid >= SYSSTAT_PIDS) {
+		return;
+	}
+
+	cli_and_save(flags);
+	for (i = 0; i < NUM_SYSCALLS; i++) {
+		sysstats[0][i].count += sysstats[pid][i].count;
+		sysstats[0][i].cycles += sysstats[pid][i].cycles;
+		for (j = 0; j < SYSSTAT_BUCKETS; j++) {
+			sysstats[0][i].hist[j] += sysstats[pid][i].hist[j];
+		}
+		memset(&(sysstats[pid][i]), 0, sizeof(sysstat_t));
+	}
+	sysstat_start[pid] = pit_ticks;
+	restore_flags(flags);
+}
+
+/*
+ * syscall_dispatch
+ *   DESCRIPTION: Called by both system call linkages with a checked call number. Runs the
+ *                handler from syscall_jump_table and records how long it took
+ *   INPUTS: index - call number minus one
+ *           a, b, c, d - arguments of the system call
+ *   OUTPUTS: none
+ *   RETURN VALUE: return value of the handler
+ */
+int32_t syscall_dispatch (uint32_t index, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	sysstat_t* stat;
+	uint32_t pid = get_pcb()->pid;
+	uint64_t start;
+	uint64_t cycles;
+	int32_t ret;
+
+	stat = &(sysstats[(pid < SYSSTAT_PIDS) ? pid : 0][index]);
+	stat->count++;
+
+	start = rdtsc64();
+	ret = syscall_jump_table[index](a, b, c, d);
+	cycles = rdtsc64() - start;
+
+	stat->cycles += cycles;
+	stat->hist[latency_bucket(cycles)]++;
+	return ret;
+}
+
+/*
+ * sysstat_open
+ *   DESCRIPTION: Does nothing, reading starts at the first record
+ *   INPUTS: filename - ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0
+ */
+int32_t sysstat_open (const uint8_t* filename) {
+	return 0;
+}
+
+/*
+ * sysstat_close
+ *   DESCRIPTION: Does nothing
+ *   INPUTS: fd - ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0
+ */
+int32_t sysstat_close (uint32_t fd) {
+	return 0;
+}
+
+/*
+ * sysstat_read
+ *   DESCRIPTION: Copies out as many whole records as fit, skipping system calls a pid never
+ *                made. The file position counts (pid, call) slots already passed
+ *   INPUTS: fd - file descriptor of the open sysstat file
+ *           nbytes - size of the buffer
+ *   OUTPUTS: buf - filled with sysstat_t records
+ *   RETURN VALUE: number of bytes written, 0 once every record was read, -1 if the buffer
+ *                 cannot hold one record
+ */
+int32_t sysstat_read (uint32_t fd, void* buf, uint32_t nbytes) {
+	sysstat_t* out = (sysstat_t*) buf;
+	pcb_t* pcb = get_pcb();
+	uint32_t slot;
+	uint32_t copied = 0;
+
+	if (fd >= FARRAY_SIZE || buf == NULL || nbytes < sizeof(sysstat_t)) {
+		return -1;
+	}
+
+	for (slot = pcb->file_array[fd].file_pos; slot < SYSSTAT_PIDS * NUM_SYSCALLS; slot++) {
+		if (sysstats[slot / NUM_SYSCALLS][slot % NUM_SYSCALLS].count == 0) {
+			continue;
+		}
+		if (nbytes - copied < sizeof(sysstat_t)) {
+			break;
+		}
+		memcpy(out, &(sysstats[slot / NUM_SYSCALLS][slot % NUM_SYSCALLS]), sizeof(sysstat_t));
+		out->pid = slot / NUM_SYSCALLS;
+		out->syscall = slot % NUM_SYSCALLS + 1;
+		out->start_tick = sysstat_start[slot / NUM_SYSCALLS];
+		out++;
+		copied += sizeof(sysstat_t);
+	}
+
+	pcb->file_array[fd].file_pos = slot;
+	return copied;
+}
+
+/*
+ * sysstat_write
+ *   DESCRIPTION: Does nothing, the statistics are read-only
+ *   INPUTS: fd, buf, nbytes - ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1
+ */
+int32_t sysstat_write (uint32_t fd, const void* buf, uint32_t nbytes) {
+	return -1;
+}
+
+/*
+ * sysstat_poll
+ *   DESCRIPTION: Reads never wait
+ *   INPUTS: fd - ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: POLLIN
+ */
+int32_t sysstat_poll (uint32_t fd) {
+	return POLLIN;
+}
@@ -0,0 +1,29 @@
+#ifndef _SYSSTAT_H
+#define _SYSSTAT_H
+
+#include "types.h"
+
+#define SYSSTAT_BUCKETS 32 // log2 latency buckets, the last also holds anything longer
+#define SYSSTAT_PIDS 32 // rows of statistics, calls by higher pids go in row 0
+
+// Statistics for one system call, as read from the sysstat file. A row covers the process
+// that holds its pid now or held it last, from start_tick on. Row 0 (pid 0 is never used)
+// collects the earlier processes whose pid was reused, and pids without a row of their own
+typedef struct sysstat_record {
+	uint32_t pid;
+	uint32_t syscall; // call number, 1 for halt
+	uint32_t start_tick; // pit_ticks when the row's process was created, 0 for row 0
+	uint32_t count; // calls made, counted on entry so halt shows up too
+	uint64_t cycles; // total TSC cycles spent in calls that returned
+	uint32_t hist[SYSSTAT_BUCKETS]; // hist[i] counts calls taking 2^i to 2^(i+1)-1 cycles
+} sysstat_t;
+
+extern void sysstat_reset (uint32_t pid);
+extern int32_t syscall_dispatch (uint32_t index, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+extern int32_t sysstat_open (const uint8_t* filename);
+extern int32_t sysstat_close (uint32_t fd);
+extern int32_t sysstat_read (uint32_t fd, void* buf, uint32_t nbytes);
+extern int32_t sysstat_write (uint32_t fd, const void* buf, uint32_t nbytes);
+extern int32_t sysstat_poll (uint32_t fd);
+
+#endif
@@ -5,10 +5,12 @@
 #include "x86_desc.h"
 #include "keyboard.h"
 #include "pcb.h"
+#include "waitqueue.h"
 
 extern char term_buf[3][BUF_LIMIT];
 extern uint8_t buf_size;
 extern volatile uint8_t enter_flag[3];
+extern wait_queue_t enter_wait[3];
 
 /*
  * open_terminal
@@ -41,19 +43,29 @@ int32_t close_terminal(uint32_t fd)
  *              buf -- the buf into which we write the keyboard buffer
  *              nbytes -- number of characters to read
  *      OUTPUTS: buf -- filled in buffer
- *      RETURNS: number of byts read
+ *      RETURNS: number of byts read, -1 if a signal is about to kill the program
  */
 int32_t read_terminal(uint32_t fd, void* buf, uint32_t nbytes)
 {
     int i, len;
     pcb_t * pcb = get_pcb();
 
-    while (enter_flag[pcb->terminal] == 0); // wait for enter to be pressed
+    // sleep until enter is pressed, or until a signal that kills the program
+    cli();
+    while (enter_flag[pcb->terminal] == 0) {
+        if (signal_fatal(pcb)) {
+            sti();
+            return -1;
+        }
+        wait_sleep(&enter_wait[pcb->terminal]);
+        cli();
+    }
     enter_flag[pcb->terminal] = 0;
+    sti();
     len = (nbytes > buf_size ? buf_size : nbytes); // if nbytes is greater than the number of chars in buffer, set length to number of chars in buffer
     i = 0;
-    // clear buffer
-    while(((char*)buf)[i] != '\0')
+    // clear buffer, never past the nbytes the caller checked
+    while(i < nbytes && ((char*)buf)[i] != '\0')
     {
         ((char*)buf)[i] = '\0';
         i++;
@@ -67,6 +79,32 @@ int32_t read_terminal(uint32_t fd, void* buf, uint32_t nbytes)
     return len;
 }
 
+/*
+ * poll_stdin
+ *      reports whether a read would return without waiting for enter
+ *      INPUTS: fd -- ignored, the terminal may be dup'd to any descriptor
+ *      OUTPUTS: none
+ *      RETURNS: POLLIN once enter has been pressed, 0 otherwise
+ */
+int32_t poll_stdin(uint32_t fd)
+{
+    pcb_t * pcb = get_pcb();
+
+    return enter_flag[pcb->terminal] ? POLLIN : 0;
+}
+
+/*
+ * poll_stdout
+ *      reports that a write would not wait
+ *      INPUTS: fd -- ignored
+ *      OUTPUTS: none
+ *      RETURNS: POLLOUT, writes go straight to the screen
+ */
+int32_t poll_stdout(uint32_t fd)
+{
+    return POLLOUT;
+}
+
 /*
  * write_terminal
  *      writes given buffer onto screen
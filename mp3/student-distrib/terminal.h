@@ -11,3 +11,5 @@ extern int32_t open_terminal(const uint8_t* filename);
 extern int32_t close_terminal(uint32_t fd);
 extern int32_t write_terminal(uint32_t fd, const void* buf, uint32_t nbytes);
 extern int32_t read_terminal(uint32_t fd, void* buf, uint32_t nbytes);
+extern int32_t poll_stdin(uint32_t fd);
+extern int32_t poll_stdout(uint32_t fd);
@@ -7,6 +7,15 @@
 #include "filesys.h"
 #include "rtc.h"
 #include "terminal.h"
+#include "scheduling.h"
+#include "syscall.h"
+#include "blockcache.h"
+#include "pcb.h"
+#include "usercopy.h"
+#include "sysstat.h"
+#include "pipe.h"
+#include "timer.h"
+#include "waitqueue.h"
 
 #define PASS 1
 #define FAIL 0
@@ -594,6 +603,1119 @@ int test_read_write_terminal()
 /* Checkpoint 4 tests */
 /* Checkpoint 5 tests */
 
+/*
+ * file_stat_test()
+ *   Asserts: file_stat reports type, length and block count of files
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int file_stat_test() {
+	stat_t st;
+	dentry_t dentry;
+
+	if (file_stat((uint8_t*) "frame0.txt", &st) == -1) {
+		printf("FAILED STAT");
+		return FAIL;
+	}
+	read_dentry_by_name((uint8_t*) "frame0.txt", &dentry);
+	if (st.file_type != 2 || st.inode_num != dentry.inode_num ||
+		st.length != inode_length(dentry.inode_num) ||
+		st.blocks != (st.length + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE) {
+		printf("BAD FILE STAT");
+		return FAIL;
+	}
+
+	if (file_stat((uint8_t*) ".", &st) == -1 || st.file_type != 1 || st.length != 0) {
+		printf("BAD DIRECTORY STAT");
+		return FAIL;
+	}
+
+	if (file_stat((uint8_t*) "this_is_bad_input", &st) != -1) {
+		printf("STAT FOUND MISSING FILE");
+		return FAIL;
+	}
+
+	return PASS;
+}
+
+
+/*
+ * file_pread_lseek_test()
+ *   Asserts: pread and lseek agree with reading the file from the start
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int file_pread_lseek_test() {
+	int fd;
+	int i;
+	int32_t length;
+	uint8_t whole[64];
+	uint8_t part[16];
+
+	fd = file_open((uint8_t*) "verylargetextwithverylongname.tx");
+	if (fd == -1) {
+		printf("FAILED OPEN");
+		return FAIL;
+	}
+	length = file_lseek(fd, 0, SEEK_END);
+	file_lseek(fd, 0, SEEK_SET);
+
+	if (file_read(fd, whole, 64) != 64) {
+		printf("FAILED READ");
+		close_syscall(fd);
+		return FAIL;
+	}
+
+	// pread does not move the position, which is now 64
+	if (file_pread(fd, part, 16, 20) != 16 || strncmp((int8_t*) part, (int8_t*) whole + 20, 16) != 0) {
+		printf("BAD PREAD");
+		close_syscall(fd);
+		return FAIL;
+	}
+
+	// seek back into the middle of a block and read through the cursor
+	if (file_lseek(fd, -40, SEEK_CUR) != 24 || file_read(fd, part, 16) != 16
+			|| strncmp((int8_t*) part, (int8_t*) whole + 24, 16) != 0) {
+		printf("BAD SEEK");
+		close_syscall(fd);
+		return FAIL;
+	}
+
+	// across a block boundary and at the end of the file
+	for (i = 0; i < 2; i++) {
+		if (file_lseek(fd, FS_BLOCK_SIZE - 8, SEEK_SET) != FS_BLOCK_SIZE - 8
+				|| file_read(fd, part, 16) != 16) {
+			printf("BAD BLOCK SEEK");
+			close_syscall(fd);
+			return FAIL;
+		}
+	}
+	if (file_lseek(fd, 0, SEEK_END) != length || file_read(fd, part, 16) != 0
+			|| file_pread(fd, part, 16, length) != 0 || file_lseek(fd, 1, SEEK_END) != -1) {
+		printf("BAD END SEEK");
+		close_syscall(fd);
+		return FAIL;
+	}
+
+	close_syscall(fd);
+
+	return PASS;
+}
+
+/*
+ * poll_ready_test()
+ *   Asserts: files are always ready, and the RTC becomes ready after one tick
+ *            and stops being ready once the tick is read
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: sets the RTC to 32Hz for this process
+ */
+int poll_ready_test() {
+	int freq = 32;
+	int garbage;
+	pcb_t* pcb = get_pcb();
+
+	if (fdir_poll(0) != (POLLIN | POLLOUT) || file_poll(0) != (POLLIN | POLLOUT)) {
+		printf("FILE NOT READY");
+		return FAIL;
+	}
+
+	write_rtc(0, &freq, 4);
+	if (poll_rtc(0) != 0) {
+		printf("RTC READY TOO EARLY");
+		return FAIL;
+	}
+	pcb->freq_wait = 0; // stand in for the handler counting down the tick
+	if (poll_rtc(0) != POLLIN) {
+		printf("RTC NOT READY");
+		return FAIL;
+	}
+	read_rtc(0, &garbage, 4);
+	if (poll_rtc(0) != 0) {
+		printf("RTC TICK NOT CONSUMED");
+		return FAIL;
+	}
+
+	return PASS;
+}
+
+/*
+ * user_range_test()
+ *   Asserts: user_range checks the whole buffer, and user copies refuse kernel memory
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int user_range_test() {
+	uint8_t kbuf[8];
+
+	if (user_range((void*) USER_VMEM, FOUR_MI_B, 1) != 0
+			|| user_range((void*) (USER_VMEM + FOUR_MI_B - 4), 4, 1) != 0) {
+		printf("GOOD RANGE REFUSED");
+		return FAIL;
+	}
+
+	// starts in user memory but runs past its end
+	if (user_range((void*) (USER_VMEM + FOUR_MI_B - 4), 8, 1) != -1
+			|| user_range((void*) (USER_VMEM + 16), 0xFFFFFFF0, 0) != -1) {
+		printf("OVERRUN ACCEPTED");
+		return FAIL;
+	}
+
+	if (copy_to_user(kbuf, "kernel", 7) != -1 || copy_from_user(kbuf, (void*) 0x400000, 8) != -1
+			|| strncpy_from_user(kbuf, (uint8_t*) "kernel", 8) != -1) {
+		printf("KERNEL MEMORY ACCEPTED");
+		return FAIL;
+	}
+
+	// only the user copy instructions have fixups
+	if (search_exception_table((uint32_t) user_range_test) != 0) {
+		printf("BAD FIXUP");
+		return FAIL;
+	}
+
+	return PASS;
+}
+
+/*
+ * sysstat_test()
+ *   Asserts: syscall_dispatch counts a call, and the sysstat file reports it
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: counts a close(-1) for the current pid, moves fd 7's file position
+ */
+int sysstat_test() {
+	pcb_t* pcb = get_pcb();
+	sysstat_t recs[2];
+	uint32_t before = 0;
+	uint32_t after = 0;
+	int32_t cnt;
+	int32_t i;
+	int32_t pass;
+
+	if (sysstat_read(7, recs, sizeof(sysstat_t) - 1) != -1) {
+		printf("SHORT BUFFER ACCEPTED");
+		return FAIL;
+	}
+
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 1 && syscall_dispatch(5, (uint32_t) -1, 0, 0, 0) != -1) { // close(-1)
+			printf("CLOSE(-1) SUCCEEDED");
+			return FAIL;
+		}
+		pcb->file_array[7].file_pos = 0;
+		while ((cnt = sysstat_read(7, recs, sizeof(recs))) > 0) {
+			for (i = 0; i < cnt / (int32_t) sizeof(sysstat_t); i++) {
+				if (recs[i].pid == pcb->pid && recs[i].syscall == 6) {
+					*(pass ? &after : &before) = recs[i].count;
+				}
+			}
+		}
+	}
+
+	if (after != before + 1) {
+		printf("CALL NOT COUNTED");
+		return FAIL;
+	}
+	return PASS;
+}
+
+/*
+ * sysstat_reset_test()
+ *   Asserts: a new process with a reused pid starts from an empty row, and what the old
+ *            one did is folded into row 0
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: folds the current pid's statistics into row 0, moves fd 7's file position
+ */
+int sysstat_reset_test() {
+	pcb_t* pcb = get_pcb();
+	sysstat_t recs[2];
+	uint32_t own[2] = {0, 0};
+	uint32_t old[2] = {0, 0};
+	int32_t cnt;
+	int32_t i;
+	int32_t pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 0) {
+			syscall_dispatch(5, (uint32_t) -1, 0, 0, 0); // close(-1)
+		} else {
+			sysstat_reset(pcb->pid);
+		}
+		pcb->file_array[7].file_pos = 0;
+		while ((cnt = sysstat_read(7, recs, sizeof(recs))) > 0) {
+			for (i = 0; i < cnt / (int32_t) sizeof(sysstat_t); i++) {
+				if (recs[i].syscall != 6) {
+					continue;
+				}
+				if (recs[i].pid == pcb->pid) {
+					own[pass] = recs[i].count;
+				} else if (recs[i].pid == 0) {
+					old[pass] = recs[i].count;
+				}
+			}
+		}
+	}
+
+	if (own[0] == 0 || own[1] != 0 || old[1] != old[0] + own[0]) {
+		printf("ROW NOT FOLDED");
+		return FAIL;
+	}
+	return PASS;
+}
+
+
+#define TEST_PROCESSES 24 // well past the old limit of 6
+
+/*
+ * process_alloc_test()
+ *   Asserts: many processes can exist at once, each with its own pid and an aligned PCB, and
+ *            freeing them returns every frame to the pool
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int process_alloc_test() {
+	pcb_t* pcbs[TEST_PROCESSES];
+	uint32_t before = frames_available();
+	int i, j;
+	int result = PASS;
+
+	for (i = 0; i < TEST_PROCESSES; i++) {
+		pcbs[i] = pcb_alloc();
+		if (pcbs[i] == NULL || ((uint32_t) pcbs[i] & (KSTACK_SIZE - 1)) != 0
+				|| pid_to_pcb(pcbs[i]->pid) != pcbs[i] || pcbs[i]->user_table == NULL) {
+			printf("BAD PCB %d", i);
+			result = FAIL;
+		}
+		for (j = 0; j < i && result == PASS; j++) {
+			if (pcbs[j]->pid == pcbs[i]->pid) {
+				printf("PID %d REUSED", pcbs[i]->pid);
+				result = FAIL;
+			}
+		}
+	}
+
+	for (i = 0; i < TEST_PROCESSES; i++) {
+		pcb_free(pcbs[i]);
+	}
+
+	if (frames_available() != before) {
+		printf("FRAMES LEAKED");
+		result = FAIL;
+	}
+	return result;
+}
+
+/*
+ * child_list_test()
+ *   Asserts: new processes start blocked, and children are linked into and out of their
+ *            parent's child list
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int child_list_test() {
+	pcb_t* parent = pcb_alloc();
+	pcb_t* kids[3];
+	pcb_t* pcb;
+	int i;
+	int result = PASS;
+
+	if (parent == NULL) {
+		return FAIL;
+	}
+
+	for (i = 0; i < 3; i++) {
+		kids[i] = pcb_alloc();
+		if (kids[i] == NULL || kids[i]->state != PROC_BLOCKED) {
+			printf("BAD CHILD %d", i);
+			result = FAIL;
+		}
+		if (kids[i] != NULL) {
+			pcb_add_child(parent, kids[i]);
+		}
+	}
+
+	if (result == PASS) {
+		pcb_remove_child(parent, kids[1]);
+		// newest first, with the middle one gone
+		if (parent->children != kids[2] || kids[2]->sibling != kids[0] || kids[0]->sibling != NULL
+				|| kids[1]->parent != NULL || kids[0]->parent != parent) {
+			printf("BAD CHILD LIST");
+			result = FAIL;
+		}
+	}
+
+	for (pcb = parent->children; pcb != NULL; pcb = parent->children) {
+		pcb_remove_child(parent, pcb);
+	}
+	for (i = 0; i < 3; i++) {
+		pcb_free(kids[i]);
+	}
+	pcb_free(parent);
+	return result;
+}
+
+/*
+ * pipe_test()
+ *   Asserts: data comes out of a pipe in order across the end of its ring, readiness follows
+ *            the fill level, reads see the end once the write end closes, and the pipe's frame
+ *            is freed with its last end
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+static uint8_t pipe_out[PIPE_SIZE];
+static uint8_t pipe_in[PIPE_SIZE];
+static int pipe_same(uint32_t len) {
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		if (pipe_in[i] != pipe_out[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int pipe_test() {
+	int32_t fds[2];
+	uint32_t free = frames_available();
+	uint32_t i;
+	int result = PASS;
+
+	for (i = 0; i < PIPE_SIZE; i++) {
+		pipe_out[i] = (uint8_t) (i * 7);
+	}
+
+	if (pipe_create(fds) == -1 || frames_available() != free - 1) {
+		printf("PIPE NOT CREATED");
+		return FAIL;
+	}
+
+	if (pipe_poll(fds[0]) != 0 || pipe_poll(fds[1]) != POLLOUT) {
+		printf("EMPTY PIPE READINESS WRONG");
+		result = FAIL;
+	}
+
+	// move the read position so the next full write wraps
+	if (pipe_write(fds[1], pipe_out, 3000) != 3000 || pipe_read(fds[0], pipe_in, PIPE_SIZE) != 3000
+			|| !pipe_same(3000)) {
+		printf("SHORT TRANSFER WRONG");
+		result = FAIL;
+	}
+
+	if (pipe_write(fds[1], pipe_out, PIPE_SIZE) != PIPE_SIZE || pipe_poll(fds[1]) != 0
+			|| pipe_poll(fds[0]) != POLLIN) {
+		printf("FULL PIPE WRONG");
+		result = FAIL;
+	}
+	if (pipe_read(fds[0], pipe_in, 100) != 100
+			|| pipe_read(fds[0], pipe_in + 100, PIPE_SIZE) != PIPE_SIZE - 100
+			|| !pipe_same(PIPE_SIZE)) {
+		printf("WRAPPED TRANSFER WRONG");
+		result = FAIL;
+	}
+
+	close_syscall(fds[1]);
+	if (pipe_read(fds[0], pipe_in, PIPE_SIZE) != 0 || pipe_poll(fds[0]) != POLLIN) {
+		printf("NO END OF FILE");
+		result = FAIL;
+	}
+
+	close_syscall(fds[0]);
+	if (frames_available() != free) {
+		printf("PIPE NOT FREED");
+		result = FAIL;
+	}
+
+	return result;
+}
+
+/*
+ * signal_test()
+ *   Asserts: new processes count down the default alarm, ALARM is raised once a shorter
+ *            period runs out, and only unhandled killing signals count as fatal
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int signal_test() {
+	pcb_t* pcb = pcb_alloc();
+	uint32_t flags;
+	int i;
+	int result = PASS;
+
+	if (pcb == NULL) {
+		return FAIL;
+	}
+
+	if (pcb->alarm_period != ALARM_DEFAULT_MS || pcb->sig_pending != 0 || signal_fatal(pcb)) {
+		printf("BAD NEW PROCESS");
+		result = FAIL;
+	}
+
+	// two PIT ticks of alarm
+	pcb->alarm_period = 2 * (1000 / PIT_FREQ);
+	pcb->alarm_left = pcb->alarm_period;
+	for (i = 0; i < 2; i++) {
+		if (pcb->sig_pending & (1 << SIG_ALARM)) {
+			printf("ALARM TOO EARLY");
+			result = FAIL;
+		}
+		cli_and_save(flags);
+		signal_tick();
+		restore_flags(flags);
+	}
+	if (!(pcb->sig_pending & (1 << SIG_ALARM)) || pcb->alarm_left != pcb->alarm_period
+			|| signal_fatal(pcb)) {
+		printf("NO ALARM");
+		result = FAIL;
+	}
+
+	signal_raise(pcb, SIG_INTERRUPT);
+	if (!signal_fatal(pcb)) {
+		printf("INTERRUPT NOT FATAL");
+		result = FAIL;
+	}
+	pcb->sig_handlers[SIG_INTERRUPT] = (void*) USER_VMEM;
+	if (signal_fatal(pcb)) {
+		printf("HANDLED INTERRUPT FATAL");
+		result = FAIL;
+	}
+
+	pcb_free(pcb);
+	return result;
+}
+
+static int timer_fired[3]; // pit_ticks each test timer fired at, by index in data
+
+/*
+ * timer_test_callback()
+ *   Records when a timer_test timer fired
+ */
+static void timer_test_callback(ktimer_t* timer) {
+	timer_fired[(uint32_t) timer->data] = pit_ticks;
+}
+
+/*
+ * timer_test()
+ *   Asserts: timers fire on the tick they are due, including ones a full turn of the wheel
+ *            away, and cancelled timers never fire
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: advances pit_ticks by hand
+ */
+int timer_test() {
+	ktimer_t timers[4];
+	uint32_t delays[3] = {1, 2, TIMER_WHEEL_SIZE + 1};
+	uint32_t start;
+	uint32_t flags;
+	int i;
+	int result = PASS;
+
+	cli_and_save(flags);
+	start = pit_ticks;
+	for (i = 0; i < 3; i++) {
+		timer_fired[i] = -1;
+		timer_add(&timers[i], delays[i], timer_test_callback, (void*) i);
+	}
+	// same slot as the first, cancelled before it is due
+	timer_add(&timers[3], 1, timer_test_callback, (void*) 0);
+	timer_cancel(&timers[3]);
+	if (timer_armed(&timers[3]) || !timer_armed(&timers[0])) {
+		printf("BAD ARMED STATE");
+		result = FAIL;
+	}
+
+	for (i = 0; i < TIMER_WHEEL_SIZE + 1; i++) {
+		pit_ticks++;
+		timer_tick();
+	}
+	restore_flags(flags);
+
+	for (i = 0; i < 3; i++) {
+		if (timer_fired[i] != start + delays[i] || timer_armed(&timers[i])) {
+			printf("TIMER %d FIRED AT %d, DUE %d", i, timer_fired[i] - start, delays[i]);
+			result = FAIL;
+		}
+	}
+
+	return result;
+}
+
+/*
+ * wait_queue_test()
+ *   Asserts: wake_up_one wakes the longest waiter first, a killing signal takes a waiter
+ *            off its queue, and wake_up_all empties the queue
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int wait_queue_test() {
+	wait_queue_t queue;
+	pcb_t* pcbs[3];
+	uint32_t flags;
+	int i;
+	int result = PASS;
+
+	for (i = 0; i < 3; i++) {
+		pcbs[i] = pcb_alloc();
+		if (pcbs[i] == NULL) {
+			while (i-- > 0) {
+				pcb_free(pcbs[i]);
+			}
+			return FAIL;
+		}
+	}
+
+	wait_queue_init(&queue);
+	cli_and_save(flags);
+	for (i = 0; i < 3; i++) {
+		pcbs[i]->state = PROC_RUNNABLE;
+		wait_add(&queue, pcbs[i]);
+	}
+	restore_flags(flags);
+
+	wake_up_one(&queue);
+	if (pcbs[0]->state != PROC_RUNNABLE || pcbs[0]->wait_queue != NULL
+			|| pcbs[1]->state != PROC_BLOCKED || queue.head != pcbs[1]) {
+		printf("WRONG PROCESS WOKEN");
+		result = FAIL;
+	}
+
+	signal_raise(pcbs[1], SIG_INTERRUPT);
+	if (pcbs[1]->state != PROC_RUNNABLE || queue.head != pcbs[2] || queue.tail != pcbs[2]) {
+		printf("SIGNAL DID NOT WAKE");
+		result = FAIL;
+	}
+
+	wake_up_all(&queue);
+	if (pcbs[2]->state != PROC_RUNNABLE || queue.head != NULL || queue.tail != NULL) {
+		printf("QUEUE NOT EMPTIED");
+		result = FAIL;
+	}
+
+	for (i = 0; i < 3; i++) {
+		pcb_free(pcbs[i]);
+	}
+	return result;
+}
+
+/*
+ * idle_test()
+ *   Asserts: halting in the idle context until the next PIT tick counts that tick as idle
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: none
+ */
+int idle_test() {
+	uint32_t start, idle_start;
+	uint32_t flags;
+
+	cli_and_save(flags);
+	start = pit_ticks;
+	idle_start = idle_ticks;
+	// other interrupts may end a halt first
+	while (pit_ticks == start) {
+		idle();
+	}
+	restore_flags(flags);
+
+	if (idle_ticks == idle_start) {
+		printf("TICK NOT IDLE");
+		return FAIL;
+	}
+	return PASS;
+}
+
+/* Benchmarks */
+
+#define BENCH_ROUNDS 1000
+#define BENCH_FILE_ROUNDS 100
+#define BENCH_DIR_SAMPLES 256
+
+static uint32_t bench_cycles_per_ms = 0; // TSC cycles per millisecond, set by bench_calibrate
+
+/*
+ * bench_calibrate()
+ *   Measures the TSC rate against the PIT. Needs interrupts enabled.
+ *   Inputs: none
+ *   Outputs: none
+ *   Side effects: Sets bench_cycles_per_ms, spins for 10 PIT ticks
+ */
+static void bench_calibrate() {
+	uint32_t tick;
+	uint32_t start;
+
+	if (bench_cycles_per_ms != 0) {
+		return;
+	}
+
+	// wait for the start of a tick
+	tick = pit_ticks;
+	while (pit_ticks == tick);
+
+	start = rdtsc();
+	tick = pit_ticks;
+	while (pit_ticks - tick < 10);
+
+	bench_cycles_per_ms = (rdtsc() - start) / (10 * 1000 / PIT_FREQ);
+	if (bench_cycles_per_ms == 0) {
+		bench_cycles_per_ms = 1;
+	}
+}
+
+/*
+ * bench_rate()
+ *   Converts an operation count and elapsed TSC cycles into operations per second
+ *   Inputs: ops - number of operations
+ *           cycles - TSC cycles they took
+ *   Outputs: operations per second
+ */
+static uint32_t bench_rate(uint32_t ops, uint32_t cycles) {
+	uint32_t us = cycles / (bench_cycles_per_ms / 1000 + 1); // microseconds, rounded to avoid dividing by zero
+
+	if (us == 0) {
+		us = 1;
+	}
+
+	// keep intermediate products inside 32 bits
+	if (ops > 4000) {
+		return (ops / us) * 1000000 + ((ops % us) * 1000) / us * 1000;
+	}
+	return (ops * 1000000) / us;
+}
+
+/*
+ * linear_dir_scan()
+ *   Linear scan over every entry of the directory, extended ones included, as a stand-in
+ *   for the original lookup on directories too big for the boot block
+ *   Inputs: fname - pointer to filename string
+ *           dentry - data entry struct to write to
+ *   Outputs: -1 on failure, 0 on success.
+ */
+static int32_t linear_dir_scan(const uint8_t* fname, dentry_t* dentry) {
+	int i;
+	char desired[33];
+	char actual[33];
+	dentry_t entry;
+
+	for (i = 0; read_dentry_by_index(i, &entry) != -1; i++) {
+		memcpy (desired, fname, FNAME_MAX_LEN + 1);
+		memcpy (actual, entry.file_name, FNAME_MAX_LEN);
+		actual[32] = '\0';
+
+		if (strncmp(actual, desired, FNAME_MAX_LEN + 1) == 0) {
+			memcpy(dentry, &entry, sizeof(dentry_t));
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * linear_dentry_lookup()
+ *   Exact copy of the original read_dentry_by_name, scanning the boot block in place, kept
+ *   as the baseline the hash index is measured against
+ *   Inputs: fname - pointer to filename string
+ *           dentry - data entry struct to write to
+ *   Outputs: -1 on failure, 0 on success.
+ */
+static int32_t linear_dentry_lookup(const uint8_t* fname, dentry_t* dentry) {
+	const boot_block_t* boot_block = filesys_boot_block();
+	int i;
+	char desired[33];
+	char actual[33];
+
+	if (dentry == NULL || fname == NULL) {
+		return -1;
+	}
+
+	if (*fname == '\0') {
+		return -1;
+	}
+
+	for (i = 0; i < DENTRY_COUNT; i++) {
+		memcpy (desired, fname, FNAME_MAX_LEN + 1);
+		memcpy (actual, boot_block->entries[i].file_name, FNAME_MAX_LEN);
+		actual[32] = '\0';
+
+		if (strncmp(actual, desired, FNAME_MAX_LEN + 1) == 0) { // if all 32 characters + terminator match
+			memcpy(dentry, &(boot_block->entries[i]), sizeof(dentry_t));
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * dentry_lookup_benchmark()
+ *   Asserts: every name in the boot block is found by the hashed lookup and by open/close
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: Prints lookups per second for the linear scan, the hash index and open/close
+ */
+int dentry_lookup_benchmark() {
+	TEST_HEADER;
+
+	char names[DENTRY_COUNT][FNAME_MAX_LEN + 1];
+	uint32_t types[DENTRY_COUNT];
+	int count;
+	int i, round, fd;
+	uint32_t start, linear, hashed, opened;
+	dentry_t dentry;
+	int result = PASS;
+
+	bench_calibrate();
+
+	// collect every name in the image
+	for (count = 0; count < DENTRY_COUNT; count++) {
+		if (read_dentry_by_index(count, &dentry) == -1 || dentry.file_name[0] == '\0') {
+			break;
+		}
+		memcpy(names[count], dentry.file_name, FNAME_MAX_LEN);
+		names[count][FNAME_MAX_LEN] = '\0';
+		types[count] = dentry.file_type;
+	}
+
+	start = rdtsc();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			linear_dentry_lookup((uint8_t*) names[i], &dentry);
+		}
+	}
+	linear = rdtsc() - start;
+
+	start = rdtsc();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (read_dentry_by_name((uint8_t*) names[i], &dentry) == -1) {
+				result = FAIL;
+			}
+		}
+	}
+	hashed = rdtsc() - start;
+
+	// open/close the whole image, skipping rtc since opening it reprograms the chip
+	start = rdtsc();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (types[i] == 0) {
+				continue;
+			}
+			fd = file_open((uint8_t*) names[i]);
+			if (fd == -1) {
+				result = FAIL;
+				continue;
+			}
+			close_syscall(fd);
+		}
+	}
+	opened = rdtsc() - start;
+
+	printf("%d names, %d rounds\n", count, BENCH_ROUNDS);
+	printf("linear scan: %u lookups/s (%u cycles each)\n", bench_rate(count * BENCH_ROUNDS, linear), linear / (count * BENCH_ROUNDS));
+	printf("hash index:  %u lookups/s (%u cycles each)\n", bench_rate(count * BENCH_ROUNDS, hashed), hashed / (count * BENCH_ROUNDS));
+	printf("open/close:  %u pairs/s\n", bench_rate(count * BENCH_ROUNDS, opened));
+
+	return result;
+}
+
+/*
+ * bigdir_lookup_benchmark()
+ *   Asserts: every entry of the directory is found by name, and made-up names are not
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: Prints lookups per second for the linear scan and the hash index over names
+ *                 spread across the directory. Meant for an image made with tools/bigdirfs
+ */
+int bigdir_lookup_benchmark() {
+	TEST_HEADER;
+
+	static char names[BENCH_DIR_SAMPLES][FNAME_MAX_LEN + 1];
+	char name[FNAME_MAX_LEN + 1];
+	uint32_t entries, samples, step;
+	uint32_t start, linear, hashed, missed;
+	int i, round;
+	dentry_t dentry;
+	int result = PASS;
+
+	bench_calibrate();
+
+	// every entry has to be reachable through the hash index
+	for (entries = 0; read_dentry_by_index(entries, &dentry) != -1; entries++) {
+		memcpy(name, dentry.file_name, FNAME_MAX_LEN);
+		name[FNAME_MAX_LEN] = '\0';
+		if (read_dentry_by_name((uint8_t*) name, &dentry) == -1) {
+			result = FAIL;
+		}
+	}
+	if (entries == 0) {
+		return FAIL;
+	}
+
+	// sample names evenly across the directory
+	step = (entries + BENCH_DIR_SAMPLES - 1) / BENCH_DIR_SAMPLES;
+	for (samples = 0; samples * step < entries; samples++) {
+		read_dentry_by_index(samples * step, &dentry);
+		memcpy(names[samples], dentry.file_name, FNAME_MAX_LEN);
+		names[samples][FNAME_MAX_LEN] = '\0';
+	}
+
+	start = rdtsc();
+	for (i = 0; i < samples; i++) {
+		linear_dir_scan((uint8_t*) names[i], &dentry);
+	}
+	linear = rdtsc() - start;
+
+	start = rdtsc();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < samples; i++) {
+			if (read_dentry_by_name((uint8_t*) names[i], &dentry) == -1) {
+				result = FAIL;
+			}
+		}
+	}
+	hashed = rdtsc() - start;
+
+	// misses have to probe to an empty slot
+	start = rdtsc();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < samples; i++) {
+			names[i][0] ^= 0x20; // flip case, no generated or shipped name differs only by that
+			if (read_dentry_by_name((uint8_t*) names[i], &dentry) != -1) {
+				result = FAIL;
+			}
+			names[i][0] ^= 0x20;
+		}
+	}
+	missed = rdtsc() - start;
+
+	printf("%u entries, %u sampled names\n", entries, samples);
+	printf("linear scan: %u lookups/s (%u cycles each)\n", bench_rate(samples, linear), linear / samples);
+	printf("hash hit:    %u lookups/s (%u cycles each)\n", bench_rate(samples * BENCH_ROUNDS, hashed), hashed / (samples * BENCH_ROUNDS));
+	printf("hash miss:   %u lookups/s (%u cycles each)\n", bench_rate(samples * BENCH_ROUNDS, missed), missed / (samples * BENCH_ROUNDS));
+
+	return result;
+}
+
+static uint8_t bench_buf[FS_BLOCK_SIZE * 16]; // read_data_benchmark checks each file fits before program_imgcpy
+
+/*
+ * file_throughput()
+ *   Reads a whole file through file_read in fixed chunks, BENCH_FILE_ROUNDS times
+ *   Inputs: fname - file to read
+ *           chunk - bytes per file_read call
+ *           bytes - written with the number of bytes read
+ *   Outputs: elapsed TSC cycles, 0 on failure
+ */
+static uint32_t file_throughput(char* fname, uint32_t chunk, uint32_t* bytes) {
+	int fd, round, cnt;
+	uint32_t start;
+
+	*bytes = 0;
+	start = rdtsc();
+	for (round = 0; round < BENCH_FILE_ROUNDS; round++) {
+		fd = file_open((uint8_t*) fname);
+		if (fd == -1) {
+			return 0;
+		}
+		while (0 < (cnt = file_read(fd, bench_buf, chunk))) {
+			*bytes += cnt;
+		}
+		close_syscall(fd);
+		if (cnt == -1) {
+			return 0;
+		}
+	}
+	return rdtsc() - start;
+}
+
+/*
+ * read_data_benchmark()
+ *   Asserts: large files and program images can be streamed through file_read and program_imgcpy
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: Prints KiB/s for byte-at-a-time, 1 KiB and whole-file reads of each file,
+ *                 and the block cache hits and misses they caused
+ */
+int read_data_benchmark() {
+	TEST_HEADER;
+
+	char* files[3] = {"verylargetextwithverylongname.tx", "shell", "fish"};
+	uint32_t chunks[3] = {1, 1024, sizeof(bench_buf)};
+	uint32_t cycles, bytes, start;
+	int i, j, round, read;
+	int result = PASS;
+	dentry_t dentry;
+
+	bench_calibrate();
+
+	for (i = 0; i < 3; i++) {
+		blockcache_flush();
+		for (j = 0; j < 3; j++) {
+			cycles = file_throughput(files[i], chunks[j], &bytes);
+			if (cycles == 0) {
+				result = FAIL;
+				continue;
+			}
+			printf("%s, %u byte reads: %u KiB/s\n", files[i], chunks[j], bench_rate(bytes, cycles) / 1024);
+		}
+
+		// program_imgcpy copies the whole file, so it has to fit in bench_buf
+		if (read_dentry_by_name((uint8_t*) files[i], &dentry) == -1
+				|| inode_length(dentry.inode_num) > (int32_t) sizeof(bench_buf)) {
+			printf("%s, program_imgcpy: does not fit in %u bytes\n", files[i], sizeof(bench_buf));
+			result = FAIL;
+			continue;
+		}
+
+		start = rdtsc();
+		bytes = 0;
+		for (round = 0; round < BENCH_FILE_ROUNDS; round++) {
+			read = program_imgcpy((uint8_t*) files[i], bench_buf);
+			if (read == -1) {
+				result = FAIL;
+				break;
+			}
+			bytes += read;
+		}
+		printf("%s, program_imgcpy: %u KiB/s\n", files[i], bench_rate(bytes, rdtsc() - start) / 1024);
+
+		// both stay 0 unless the image was converted with tools/compressfs
+		printf("%s, block cache: %u hits, %u misses\n", files[i], blockcache_hits, blockcache_misses);
+	}
+
+	return result;
+}
+
+
+/*
+ * exec_latency_benchmark()
+ *   Asserts: shell, fish and testprint load with both the eager and the demand-paged loader
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: Prints exec-to-first-instruction latency of each loader. Maps a scratch
+ *                 process's user memory, so run before the first shell
+ */
+int exec_latency_benchmark() {
+	TEST_HEADER;
+
+	char* prgms[3] = {"shell", "fish", "testprint"};
+	uint8_t header[28];
+	dentry_t dentry;
+	uint32_t eip, start, cycles;
+	int i, mode, round;
+	int saved = demand_load;
+	int result = PASS;
+	pcb_t* scratch = pcb_alloc();
+
+	if (scratch == NULL) {
+		return FAIL;
+	}
+
+	bench_calibrate();
+
+	for (i = 0; i < 3; i++) {
+		for (mode = 0; mode < 2; mode++) {
+			demand_load = mode;
+			cycles = 0;
+			for (round = 0; round < BENCH_FILE_ROUNDS; round++) {
+				// same steps as execute_syscall up to the iret
+				start = rdtsc();
+				if (read_dentry_by_name((uint8_t*) prgms[i], &dentry) == -1
+						|| read_data(dentry.inode_num, 0, header, 28) != 28
+						|| program_load(scratch, dentry.inode_num) == -1) {
+					result = FAIL;
+					break;
+				}
+				eip = (header[27] << 24) | (header[26] << 16) | (header[25] << 8) | header[24];
+
+				// the first instruction fetch, which faults the page in when demand loading
+				(void) *((volatile uint8_t*) eip);
+				cycles += rdtsc() - start;
+			}
+			printf("%s, %s loader: %u cycles (%u us)\n", prgms[i], mode ? "demand" : "eager",
+				cycles / BENCH_FILE_ROUNDS, cycles / BENCH_FILE_ROUNDS / (bench_cycles_per_ms / 1000 + 1));
+		}
+	}
+
+	demand_load = saved;
+	pcb_free(scratch);
+	return result;
+}
+
+
+/*
+ * dir_listing_benchmark()
+ *   Asserts: a full directory listing through fdir_getdents sees the same names as fdir_read
+ *   Inputs: none
+ *   Outputs: PASS/FAIL
+ *   Side effects: Prints calls and cycles per full listing for both interfaces
+ */
+int dir_listing_benchmark() {
+	TEST_HEADER;
+
+	dirent_t records[16];
+	uint8_t name[FNAME_MAX_LEN + 1];
+	uint32_t start, one_cycles, batch_cycles, one_calls, batch_calls;
+	int fd, round, cnt, one_names, batch_names;
+	int result = PASS;
+
+	bench_calibrate();
+
+	one_cycles = batch_cycles = one_calls = batch_calls = 0;
+	one_names = batch_names = 0;
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		// one name per call, as ls did
+		fd = file_open((uint8_t*) ".");
+		if (fd == -1) {
+			return FAIL;
+		}
+		start = rdtsc();
+		do {
+			cnt = fdir_read(fd, name, FNAME_MAX_LEN);
+			one_calls++;
+			if (cnt > 0) {
+				one_names++;
+			}
+		} while (cnt > 0);
+		one_cycles += rdtsc() - start;
+		close_syscall(fd);
+
+		// as many records as fit per call
+		fd = file_open((uint8_t*) ".");
+		if (fd == -1) {
+			return FAIL;
+		}
+		start = rdtsc();
+		do {
+			cnt = fdir_getdents(fd, records, sizeof(records));
+			batch_calls++;
+			if (cnt > 0) {
+				batch_names += cnt / sizeof(dirent_t);
+			}
+		} while (cnt > 0);
+		batch_cycles += rdtsc() - start;
+		close_syscall(fd);
+	}
+
+	if (one_names != batch_names || cnt == -1) {
+		result = FAIL;
+	}
+
+	printf("fdir_read:     %u calls, %u cycles per listing\n", one_calls / BENCH_ROUNDS, one_cycles / BENCH_ROUNDS);
+	printf("fdir_getdents: %u calls, %u cycles per listing\n", batch_calls / BENCH_ROUNDS, batch_cycles / BENCH_ROUNDS);
+
+	return result;
+}
 
 /* Test suite entry point */
 void launch_tests(){
@@ -624,4 +1746,29 @@ void launch_tests(){
 	// TEST_OUTPUT("test_read_write_terminal", test_read_write_terminal());
     assertion_failure();
 /* CHECKPOINT 3 */
+/* CHECKPOINT 5 */
+	// TEST_OUTPUT("file_stat_test", file_stat_test());
+	// TEST_OUTPUT("file_pread_lseek_test", file_pread_lseek_test());
+	// TEST_OUTPUT("poll_ready_test", poll_ready_test());
+	// TEST_OUTPUT("user_range_test", user_range_test());
+	// TEST_OUTPUT("sysstat_test", sysstat_test());
+	// TEST_OUTPUT("sysstat_reset_test", sysstat_reset_test());
+	// TEST_OUTPUT("process_alloc_test", process_alloc_test());
+	// TEST_OUTPUT("child_list_test", child_list_test());
+	// TEST_OUTPUT("pipe_test", pipe_test());
+	// TEST_OUTPUT("signal_test", signal_test());
+	// TEST_OUTPUT("timer_test", timer_test());
+	// TEST_OUTPUT("wait_queue_test", wait_queue_test());
+	// TEST_OUTPUT("idle_test", idle_test());
+}
+
+/* Benchmark entry point, run instead of the shell when kernel.c defines RUN_BENCHMARKS */
+void launch_benchmarks(){
+	clear();
+	TEST_OUTPUT("dentry_lookup_benchmark", dentry_lookup_benchmark());
+	TEST_OUTPUT("read_data_benchmark", read_data_benchmark());
+	TEST_OUTPUT("exec_latency_benchmark", exec_latency_benchmark());
+	TEST_OUTPUT("dir_listing_benchmark", dir_listing_benchmark());
+	// needs an image made with tools/bigdirfs
+	// TEST_OUTPUT("bigdir_lookup_benchmark", bigdir_lookup_benchmark());
 }
@@ -3,5 +3,7 @@
 
 // test launcher
 extern void launch_tests();
+// benchmark launcher
+extern void launch_benchmarks();
 
 #endif /* TESTS_H */
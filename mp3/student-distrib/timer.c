@@ -0,0 +1,96 @@
+#include "timer.h"
+#include "scheduling.h"
+#include "lib.h"
+
+// Hashed timing wheel: a timer sits in slot expires % TIMER_WHEEL_SIZE, so adding and
+// cancelling are O(1) and each tick only looks at the timers in one slot
+static ktimer_t * wheel[TIMER_WHEEL_SIZE];
+
+/*
+ * timer_add
+ *   DESCRIPTION: Arms a timer to fire after a number of PIT ticks
+ *   INPUTS: timer - timer to arm, not already armed
+ *           ticks - PIT ticks from now, at least one
+ *           callback - function to run when it fires
+ *           data - passed to the callback in the timer
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off
+ */
+void timer_add (ktimer_t * timer, uint32_t ticks, void (*callback)(ktimer_t *), void * data) {
+	ktimer_t ** slot;
+
+	// this tick's slot has already been run
+	if (ticks == 0) {
+		ticks = 1;
+	}
+
+	timer->expires = pit_ticks + ticks;
+	timer->callback = callback;
+	timer->data = data;
+
+	slot = &(wheel[timer->expires & (TIMER_WHEEL_SIZE - 1)]);
+	timer->next = *slot;
+	if (*slot != NULL) {
+		(*slot)->pprev = &(timer->next);
+	}
+	timer->pprev = slot;
+	*slot = timer;
+}
+
+/*
+ * timer_cancel
+ *   DESCRIPTION: Disarms a timer, if armed
+ *   INPUTS: timer - timer to disarm
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off
+ */
+void timer_cancel (ktimer_t * timer) {
+	if (timer->pprev == NULL) {
+		return;
+	}
+
+	*(timer->pprev) = timer->next;
+	if (timer->next != NULL) {
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+/*
+ * timer_armed
+ *   DESCRIPTION: Tells whether a timer has yet to fire
+ *   INPUTS: timer - timer to check
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if armed, 0 otherwise
+ */
+int32_t timer_armed (ktimer_t * timer) {
+	return (timer->pprev != NULL);
+}
+
+/*
+ * timer_tick
+ *   DESCRIPTION: Fires the timers due at the current pit_ticks. Timers in the slot that
+ *                are a whole turn of the wheel or more away stay put
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off, once per PIT tick
+ */
+void timer_tick () {
+	ktimer_t ** slot = &(wheel[pit_ticks & (TIMER_WHEEL_SIZE - 1)]);
+	ktimer_t * timer = *slot;
+
+	while (timer != NULL) {
+		if (timer->expires != pit_ticks) {
+			timer = timer->next;
+			continue;
+		}
+		timer_cancel(timer);
+		timer->callback(timer);
+		// the callback may have changed the slot, start over
+		timer = *slot;
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include "types.h"
+
+#define TIMER_WHEEL_SIZE 256 // slots, one PIT tick apart, a power of two
+
+// A one-shot kernel timer, embedded in whatever it wakes
+typedef struct ktimer {
+	struct ktimer * next; // next timer in the same wheel slot
+	struct ktimer ** pprev; // link pointing at this timer, NULL when not armed
+	uint32_t expires; // pit_ticks value it fires at
+	void (*callback)(struct ktimer *); // runs from the PIT interrupt, with interrupts off
+	void * data; // for the callback
+} ktimer_t;
+
+extern void timer_add (ktimer_t * timer, uint32_t ticks, void (*callback)(ktimer_t *), void * data);
+extern void timer_cancel (ktimer_t * timer);
+extern int32_t timer_armed (ktimer_t * timer);
+extern void timer_tick ();
+
+#endif
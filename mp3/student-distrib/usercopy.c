@@ -0,0 +1,125 @@
+#include "usercopy.h"
+#include "paging.h"
+#include "pcb.h"
+
+// Bounds of the exception table, provided by the linker for the __ex_table section
+extern exception_entry_t __start___ex_table[];
+extern exception_entry_t __stop___ex_table[];
+
+/*
+ * user_bytes_left
+ *   DESCRIPTION: Finds how much of the current process's memory follows an address. The
+ *                kernel may write only to the 128MB program region, and may also read
+ *                from the mapped part of the mmap window
+ *   INPUTS: addr - user address
+ *           write - nonzero if the kernel will write there
+ *   OUTPUTS: none
+ *   RETURN VALUE: bytes from addr to the end of its region, 0 if addr is not usable
+ */
+static uint32_t user_bytes_left (const void* addr, int32_t write) {
+	uint32_t start = (uint32_t) addr;
+	uint32_t end;
+
+	// 128 MB to 132 MB (4MB * 32 to 4MB * 33)
+	if (start >= USER_VMEM && start < USER_VMEM + FOUR_MI_B) {
+		return USER_VMEM + FOUR_MI_B - start;
+	}
+
+	if (write) {
+		return 0;
+	}
+
+	// pages mapped so far in the mmap window, from 136 MB (4MB * 34)
+	end = MMAP_VMEM + get_pcb()->mmap_pages * FOUR_KI_B;
+	if (start >= MMAP_VMEM && start < end) {
+		return end - start;
+	}
+
+	return 0;
+}
+
+/*
+ * user_range
+ *   DESCRIPTION: Checks once that a whole buffer lies in memory the current process may
+ *                hand to a system call, so drivers can then use it directly
+ *   INPUTS: addr - start of the buffer
+ *           n - length of the buffer in bytes
+ *           write - nonzero if the kernel will write to the buffer
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 if the range is valid, -1 otherwise
+ */
+int32_t user_range (const void* addr, uint32_t n, int32_t write) {
+	uint32_t left = user_bytes_left(addr, write);
+
+	return (left != 0 && n <= left) ? 0 : -1;
+}
+
+/*
+ * copy_to_user
+ *   DESCRIPTION: Copies a kernel buffer out to user memory
+ *   INPUTS: dst - user buffer
+ *           src - kernel buffer
+ *           n - number of bytes
+ *   OUTPUTS: dst
+ *   RETURN VALUE: 0 on success, -1 if dst is not writable user memory
+ */
+int32_t copy_to_user (void* dst, const void* src, uint32_t n) {
+	if (user_range(dst, n, 1) == -1) {
+		return -1;
+	}
+	return copy_user_raw(dst, src, n);
+}
+
+/*
+ * copy_from_user
+ *   DESCRIPTION: Copies user memory into a kernel buffer
+ *   INPUTS: dst - kernel buffer
+ *           src - user buffer
+ *           n - number of bytes
+ *   OUTPUTS: dst
+ *   RETURN VALUE: 0 on success, -1 if src is not readable user memory
+ */
+int32_t copy_from_user (void* dst, const void* src, uint32_t n) {
+	if (user_range(src, n, 0) == -1) {
+		return -1;
+	}
+	return copy_user_raw(dst, src, n);
+}
+
+/*
+ * strncpy_from_user
+ *   DESCRIPTION: Copies a string out of user memory, stopping at the end of the region
+ *                it starts in
+ *   INPUTS: dst - kernel buffer of n bytes
+ *           src - user string
+ *           n - size of dst
+ *   OUTPUTS: dst
+ *   RETURN VALUE: length of the string, -1 if it is not readable or does not fit in dst
+ */
+int32_t strncpy_from_user (uint8_t* dst, const uint8_t* src, uint32_t n) {
+	uint32_t left = user_bytes_left(src, 0);
+
+	if (left == 0) {
+		return -1;
+	}
+	return strncpy_user_raw(dst, src, (n < left) ? n : left);
+}
+
+/*
+ * search_exception_table
+ *   DESCRIPTION: Called by the page fault linkage for faults it could not resolve. Looks
+ *                up the faulting instruction among those allowed to touch user memory
+ *   INPUTS: eip - address of the faulting instruction
+ *   OUTPUTS: none
+ *   RETURN VALUE: address to resume at, 0 if the fault was not in a user copy
+ */
+uint32_t search_exception_table (uint32_t eip) {
+	exception_entry_t* entry;
+
+	for (entry = __start___ex_table; entry < __stop___ex_table; entry++) {
+		if (entry->insn == eip) {
+			return entry->fixup;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef _USERCOPY_H
+#define _USERCOPY_H
+
+#include "types.h"
+
+// Exception table entry: a kernel instruction allowed to fault on user memory,
+// and where to resume when it does
+typedef struct exception_entry {
+	uint32_t insn;
+	uint32_t fixup;
+} exception_entry_t;
+
+extern int32_t user_range (const void* addr, uint32_t n, int32_t write);
+extern int32_t copy_to_user (void* dst, const void* src, uint32_t n);
+extern int32_t copy_from_user (void* dst, const void* src, uint32_t n);
+extern int32_t strncpy_from_user (uint8_t* dst, const uint8_t* src, uint32_t n);
+extern uint32_t search_exception_table (uint32_t eip);
+
+// In usercopy_linkage.S, only call after user_range
+extern int32_t copy_user_raw (void* dst, const void* src, uint32_t n);
+extern int32_t strncpy_user_raw (uint8_t* dst, const uint8_t* src, uint32_t n);
+
+#endif
@@ -0,0 +1,131 @@
+#include "waitqueue.h"
+#include "pcb.h"
+#include "scheduling.h"
+#include "lib.h"
+
+/*
+ * wait_queue_init
+ *   DESCRIPTION: Empties a wait queue. Zeroed static queues are already empty
+ *   INPUTS: queue - queue to set up
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ */
+void wait_queue_init (wait_queue_t * queue) {
+	queue->head = NULL;
+	queue->tail = NULL;
+}
+
+/*
+ * wait_add
+ *   DESCRIPTION: Blocks a process on the end of a queue, without giving up the CPU
+ *   INPUTS: queue - queue to wait on
+ *           pcb - process to block, not on any queue
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off
+ */
+void wait_add (wait_queue_t * queue, pcb_t * pcb) {
+	pcb->wait_next = NULL;
+	pcb->wait_queue = queue;
+	pcb->state = PROC_BLOCKED;
+
+	if (queue->tail != NULL) {
+		queue->tail->wait_next = pcb;
+	} else {
+		queue->head = pcb;
+	}
+	queue->tail = pcb;
+}
+
+/*
+ * wait_sleep
+ *   DESCRIPTION: Blocks the current process on a queue until a wake up or a signal that
+ *                would interrupt it. Callers check their condition again afterwards
+ *   INPUTS: queue - queue to wait on
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must be called with interrupts off, returns with them on
+ */
+void wait_sleep (wait_queue_t * queue) {
+	wait_add(queue, get_pcb());
+	block();
+}
+
+/*
+ * wait_remove
+ *   DESCRIPTION: Takes a process off the queue it waits on, if any, leaving its state alone
+ *   INPUTS: pcb - process to remove
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: must run with interrupts off
+ */
+void wait_remove (pcb_t * pcb) {
+	wait_queue_t * queue = pcb->wait_queue;
+	pcb_t * prev = NULL;
+	pcb_t * cur;
+
+	if (queue == NULL) {
+		return;
+	}
+
+	for (cur = queue->head; cur != NULL; prev = cur, cur = cur->wait_next) {
+		if (cur != pcb) {
+			continue;
+		}
+		if (prev != NULL) {
+			prev->wait_next = pcb->wait_next;
+		} else {
+			queue->head = pcb->wait_next;
+		}
+		if (queue->tail == pcb) {
+			queue->tail = prev;
+		}
+		break;
+	}
+	pcb->wait_next = NULL;
+	pcb->wait_queue = NULL;
+}
+
+/*
+ * wake_up_one
+ *   DESCRIPTION: Makes the process that has waited longest on a queue runnable
+ *   INPUTS: queue - queue to wake from
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: safe from interrupt handlers
+ */
+void wake_up_one (wait_queue_t * queue) {
+	pcb_t * pcb;
+	uint32_t flags;
+
+	cli_and_save(flags);
+	pcb = queue->head;
+	if (pcb != NULL) {
+		queue->head = pcb->wait_next;
+		if (queue->head == NULL) {
+			queue->tail = NULL;
+		}
+		pcb->wait_next = NULL;
+		pcb->wait_queue = NULL;
+		pcb->state = PROC_RUNNABLE;
+	}
+	restore_flags(flags);
+}
+
+/*
+ * wake_up_all
+ *   DESCRIPTION: Makes every process waiting on a queue runnable
+ *   INPUTS: queue - queue to wake from
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: safe from interrupt handlers
+ */
+void wake_up_all (wait_queue_t * queue) {
+	uint32_t flags;
+
+	cli_and_save(flags);
+	while (queue->head != NULL) {
+		wake_up_one(queue);
+	}
+	restore_flags(flags);
+}
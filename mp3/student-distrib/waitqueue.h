@@ -0,0 +1,21 @@
+#ifndef _WAITQUEUE_H
+#define _WAITQUEUE_H
+
+#include "types.h"
+
+struct pcb_t;
+
+// Processes blocked until some event, linked through their wait_next in the order they slept
+typedef struct wait_queue {
+	struct pcb_t * head;
+	struct pcb_t * tail;
+} wait_queue_t;
+
+extern void wait_queue_init (wait_queue_t * queue);
+extern void wait_add (wait_queue_t * queue, struct pcb_t * pcb);
+extern void wait_sleep (wait_queue_t * queue);
+extern void wait_remove (struct pcb_t * pcb);
+extern void wake_up_one (wait_queue_t * queue);
+extern void wake_up_all (wait_queue_t * queue);
+
+#endif
@@ -0,0 +1,48 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define BUFSIZE 16
+
+/*
+ * Prints how busy the CPU has been since boot and over the next second,
+ * from the timer ticks that found it idle.
+ */
+
+static void
+report (const char* name, uint32_t ticks, uint32_t idle)
+{
+    uint8_t buf[BUFSIZE];
+    uint32_t busy = 0;
+
+    if (0 != ticks)
+	busy = (ticks - idle) * 100 / ticks;
+
+    ece391_fdputs (1, (uint8_t*)name);
+    ece391_itoa (busy, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)"% busy, idle for ");
+    ece391_itoa (idle, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)" of ");
+    ece391_itoa (ticks, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)" ticks\n");
+}
+
+int main ()
+{
+    ece391_cpustat_t start, end;
+
+    if (-1 == ece391_cpustat (&start)) {
+	ece391_fdputs (1, (uint8_t*)"cpustat failed\n");
+	return 3;
+    }
+    report ("since boot: ", start.ticks, start.idle_ticks);
+
+    if (-1 == ece391_sleep (1000) || -1 == ece391_cpustat (&end))
+	return 3;
+    report ("last second: ", end.ticks - start.ticks, end.idle_ticks - start.idle_ticks);
+    return 0;
+}
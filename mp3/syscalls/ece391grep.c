@@ -5,12 +5,14 @@
 
 #define BUFSIZE 1024
 #define SBUFSIZE 33
+#define NRECORDS 16
 
 int32_t
 do_one_file (const char* s, const char* fname) 
 {
     int32_t fd, cnt, last, line_start, line_end, check, s_len;
     uint8_t data[BUFSIZE+1];
+    const uint8_t* match[4] = {0, (uint8_t*)":", 0, (uint8_t*)"\n"};
 
     s_len = ece391_strlen ((uint8_t*)s);
     if (-1 == (fd = ece391_open ((uint8_t*)fname))) {
@@ -42,10 +44,9 @@ do_one_file (const char* s, const char* fname)
 	    for (check = line_start; check < line_end; check++) {
 		if (s[0] == data[check] && 
 		    0 == ece391_strncmp ((uint8_t*)(data + check), (uint8_t*)s, s_len)) {
-		    ece391_fdputs (1, (uint8_t*)fname);
-		    ece391_fdputs (1, (uint8_t*)":");
-		    ece391_fdputs (1, data + line_start);
-		    ece391_fdputs (1, (uint8_t*)"\n");
+		    match[0] = (uint8_t*)fname;
+		    match[2] = data + line_start;
+		    ece391_fdputsv (1, match, 4);
 		    break;
 		}
 	    }
@@ -67,7 +68,8 @@ do_one_file (const char* s, const char* fname)
 
 int main ()
 {
-    int32_t fd, cnt;
+    int32_t fd, cnt, i, len;
+    ece391_dirent_t records[NRECORDS];
     uint8_t buf[SBUFSIZE];
     uint8_t search[BUFSIZE];
 
@@ -81,16 +83,20 @@ int main ()
 	return 2;
     }
 
-    while (0 != (cnt = ece391_read (fd, buf, SBUFSIZE-1))) {
+    while (0 != (cnt = ece391_getdents (fd, records, sizeof (records)))) {
         if (-1 == cnt) {
 	    ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
 	    return 3;
 	}
-	if ('.' == buf[0]) /* a directory... */
-	    continue;
-	buf[cnt] = '\0';
-	if (0 != do_one_file ((char*)search, (char*)buf))
-	    return 3;
+	for (i = 0; i < cnt / (int32_t)sizeof (ece391_dirent_t); i++) {
+	    if (2 != records[i].type) /* only regular files */
+		continue;
+	    for (len = 0; len < SBUFSIZE - 1 && '\0' != records[i].name[len]; len++)
+		buf[len] = records[i].name[len];
+	    buf[len] = '\0';
+	    if (0 != do_one_file ((char*)search, (char*)buf))
+		return 3;
+	}
     }
 
     return 0;
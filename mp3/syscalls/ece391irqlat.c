@@ -0,0 +1,157 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+#include "ece391sysnum.h"
+
+#define TICKS 100
+#define CALIBRATE_TICKS 10
+#define TICK_US 10000
+#define BUFSIZE 16
+#define FILESIZE 40960
+#define EXECS 10
+
+/*
+ * Interrupt latency under long system calls.  Reads all of fish over
+ * and over for TICKS timer ticks, once through INT 0x80 and once
+ * through SYSENTER, then runs "cat created.txt" EXECS times, and prints
+ * how late the worst timer interrupt came in each run.  For the exec
+ * run only ticks that came in while the kernel loaded the program
+ * count, and the image is only copied at exec with demand_load off.
+ */
+
+static inline uint32_t
+rdtsc (void)
+{
+    uint32_t val;
+    asm volatile ("rdtsc" : "=a"(val) : : "edx");
+    return val;
+}
+
+/* read(fd, buf, n) through INT 0x80 and system_call_handler */
+static int32_t
+int80_read (int32_t fd, void* buf, int32_t n)
+{
+    int32_t ret;
+    asm volatile ("int $0x80"
+		  : "=a"(ret)
+		  : "a"(SYS_READ), "b"(fd), "c"(buf), "d"(n)
+		  : "memory", "cc");
+    return ret;
+}
+
+/* Spins until the next timer tick, returns its count */
+static uint32_t
+next_tick (void)
+{
+    ece391_cpustat_t stat;
+    uint32_t tick;
+
+    (void)ece391_cpustat (&stat);
+    tick = stat.ticks;
+    while (tick == stat.ticks)
+	(void)ece391_cpustat (&stat);
+    return stat.ticks;
+}
+
+/* rdtsc cycles in one timer tick */
+static uint32_t
+calibrate (void)
+{
+    uint32_t i, start;
+
+    (void)next_tick ();
+    start = rdtsc ();
+    for (i = 0; i < CALIBRATE_TICKS; i++)
+	(void)next_tick ();
+    return (rdtsc () - start) / CALIBRATE_TICKS;
+}
+
+static void
+report (const char* name, uint32_t count, const char* what, uint32_t worst, uint32_t period)
+{
+    uint8_t buf[BUFSIZE];
+    uint32_t late = 0;
+
+    if (worst > period)
+	late = (worst - period) / (period / TICK_US);
+
+    ece391_fdputs (1, (uint8_t*)name);
+    ece391_itoa (count, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)what);
+    ece391_fdputs (1, (uint8_t*)", worst timer latency ");
+    ece391_itoa (late, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)" us\n");
+}
+
+static int32_t
+run (const char* name, int32_t (*rd)(int32_t, void*, int32_t), uint32_t period)
+{
+    uint8_t data[FILESIZE];
+    ece391_cpustat_t stat;
+    uint32_t tick, reads = 0, worst = 0;
+    int32_t fd;
+
+    // cpustat restarts the gap measurement, so keep the worst across calls
+    tick = next_tick ();
+    (void)ece391_cpustat (&stat);
+    do {
+	if (-1 == (fd = ece391_open ((uint8_t*)"fish")))
+	    return -1;
+	if (0 >= rd (fd, data, FILESIZE)) {
+	    (void)ece391_close (fd);
+	    return -1;
+	}
+	(void)ece391_close (fd);
+	reads++;
+	(void)ece391_cpustat (&stat);
+	if (stat.max_gap > worst)
+	    worst = stat.max_gap;
+    } while (stat.ticks - tick < TICKS);
+
+    report (name, reads, " reads", worst, period);
+    return 0;
+}
+
+static int32_t
+run_exec (uint32_t period)
+{
+    ece391_cpustat_t stat;
+    uint32_t i, worst = 0;
+
+    (void)ece391_cpustat (&stat);
+    for (i = 0; i < EXECS; i++) {
+	if (0 != ece391_execute ((uint8_t*)"cat created.txt"))
+	    return -1;
+	(void)ece391_cpustat (&stat);
+	if (stat.load_max_gap > worst)
+	    worst = stat.load_max_gap;
+    }
+
+    report ("exec: ", EXECS, " loads", worst, period);
+    return 0;
+}
+
+int main ()
+{
+    uint32_t period;
+
+    period = calibrate ();
+    if (period < TICK_US) {
+	ece391_fdputs (1, (uint8_t*)"timer is not running\n");
+	return 3;
+    }
+
+    if (-1 == run ("int 0x80: ", int80_read, period) ||
+	-1 == run ("sysenter: ", ece391_read, period)) {
+	ece391_fdputs (1, (uint8_t*)"could not read fish\n");
+	return 3;
+    }
+    if (-1 == run_exec (period)) {
+	ece391_fdputs (1, (uint8_t*)"could not run cat\n");
+	return 3;
+    }
+    return 0;
+}
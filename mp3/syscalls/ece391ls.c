@@ -3,25 +3,33 @@
 #include "ece391support.h"
 #include "ece391syscall.h"
 
-#define SBUFSIZE 33
+#define NRECORDS 16
+#define NAMELEN 32
 
 int main ()
 {
-    int32_t fd, cnt;
-    uint8_t buf[SBUFSIZE];
+    int32_t fd, cnt, i, len, out_len;
+    ece391_dirent_t records[NRECORDS];
+    uint8_t out[NRECORDS * (NAMELEN + 1)];
 
     if (-1 == (fd = ece391_open ((uint8_t*)"."))) {
         ece391_fdputs (1, (uint8_t*)"directory open failed\n");
         return 2;
     }
 
-    while (0 != (cnt = ece391_read (fd, buf, SBUFSIZE-1))) {
+    while (0 != (cnt = ece391_getdents (fd, records, sizeof (records)))) {
         if (-1 == cnt) {
 	        ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
 	        return 3;
 	    }
-	    buf[cnt] = '\n';
-	    if (-1 == ece391_write (1, buf, cnt + 1))
+	    /* one write per batch of names */
+	    out_len = 0;
+	    for (i = 0; i < cnt / (int32_t)sizeof (ece391_dirent_t); i++) {
+	        for (len = 0; len < NAMELEN && '\0' != records[i].name[len]; len++)
+	            out[out_len++] = records[i].name[len];
+	        out[out_len++] = '\n';
+	    }
+	    if (-1 == ece391_write (1, out, out_len))
 	        return 3;
     }
 
@@ -12,6 +12,36 @@
 #define STARTCHAR 'A'
 #define ENDCHAR 'Z'
 
+/*
+ * Waits for the next RTC tick without spinning.  Returns 1 instead if
+ * enter was pressed first.
+ */
+static int32_t
+wait_tick (int32_t rtc_fd)
+{
+    ece391_pollfd_t fds[2];
+    uint8_t line[BUFMAX];
+    int32_t garbage, i;
+
+    fds[0].fd = rtc_fd;
+    fds[0].events = ECE391_POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = 0;
+    fds[1].events = ECE391_POLLIN;
+    fds[1].revents = 0;
+    (void)ece391_poll (fds, 2, -1);
+
+    if (fds[1].revents & ECE391_POLLIN) {
+	for (i = 0; i < BUFMAX; i++)
+	    line[i] = '\0';
+	(void)ece391_read (0, line, BUFMAX);
+	return 1;
+    }
+
+    (void)ece391_read (rtc_fd, &garbage, 4);
+    return 0;
+}
+
 int main ()
 {
     int32_t i = 0;
@@ -19,7 +49,6 @@ int main ()
     uint8_t curchar = STARTCHAR;
     uint8_t update = 1;
     int ret_val;
-    int garbage;
     int rtc_fd;
     uint8_t buf[BUFMAX];
     
@@ -53,8 +82,9 @@ int main ()
 		buf[j] = curchar;
 		ece391_fdputs (1, buf);
 
-		// Wait for RTC tick
-		ece391_read(rtc_fd, &garbage, 4);
+		// Wait for RTC tick, stop on enter
+		if (wait_tick(rtc_fd))
+		    return 0;
 	}
 	
 	// Bounce back
@@ -70,8 +100,9 @@ int main ()
 		buf[j] = curchar;
 		ece391_fdputs (1, buf);
 
-		// Wait for RTC tick
-		ece391_read(rtc_fd, &garbage, 4);
+		// Wait for RTC tick, stop on enter
+		if (wait_tick(rtc_fd))
+		    return 0;
     	}
 
 	// Edge case on characters
@@ -0,0 +1,130 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define BENCH_BYTES (10 << 20)
+#define CHUNK 4096
+#define BUFSIZE 16
+#define SAVE_FD 7
+
+/*
+ * Pipe throughput benchmark.  With no argument, spawns "pipebench sink"
+ * reading from a pipe and pushes 10 MB into it, timing until the sink
+ * halts.  "pipebench gen" writes the 10 MB to stdout and "pipebench
+ * sink" counts and times what it reads from stdin, so the shell's
+ * "pipebench gen | pipebench sink" can be measured the same way.
+ */
+
+static uint8_t data[CHUNK];
+
+static inline uint64_t
+rdtsc (void)
+{
+    uint64_t val;
+    asm volatile ("rdtsc" : "=A"(val));
+    return val;
+}
+
+/* cycles * 1024 / bytes without the 64-bit division helpers from libgcc */
+static uint32_t
+per_kb (uint64_t cycles, uint32_t bytes)
+{
+    if (0 == (bytes >> 20))
+	return 0;
+    return (uint32_t)(cycles >> 10) / (bytes >> 20);
+}
+
+static void
+report (const char* name, uint32_t val, const char* unit)
+{
+    uint8_t buf[BUFSIZE];
+
+    ece391_fdputs (1, (uint8_t*)name);
+    ece391_itoa (val, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)unit);
+}
+
+/* Writes BENCH_BYTES to fd, returns -1 if a write fails */
+static int32_t
+gen (int32_t fd)
+{
+    uint32_t i, sent;
+
+    for (i = 0; i < CHUNK; i++)
+	data[i] = (uint8_t)i;
+
+    for (sent = 0; sent < BENCH_BYTES; sent += CHUNK) {
+	if (CHUNK != ece391_write (fd, data, CHUNK))
+	    return -1;
+    }
+    return 0;
+}
+
+/* Reads stdin to the end, returns 0 if exactly BENCH_BYTES came through */
+static int32_t
+sink ()
+{
+    int32_t cnt;
+    uint32_t total = 0;
+    uint64_t start, cycles;
+
+    start = rdtsc ();
+    while (0 != (cnt = ece391_read (0, data, CHUNK))) {
+	if (-1 == cnt) {
+	    ece391_fdputs (1, (uint8_t*)"pipe read failed\n");
+	    return 3;
+	}
+	total += cnt;
+    }
+    cycles = rdtsc () - start;
+
+    report ("sink: ", total, " bytes, ");
+    report ("", per_kb (cycles, total), " cycles/KB\n");
+    return (BENCH_BYTES == total) ? 0 : 1;
+}
+
+int main ()
+{
+    uint8_t arg[BUFSIZE];
+    int32_t fds[2];
+    int32_t pid, status;
+    uint64_t start, cycles;
+
+    if (0 == ece391_getargs (arg, BUFSIZE)) {
+	if (0 == ece391_strcmp (arg, (uint8_t*)"gen"))
+	    return (-1 == gen (1)) ? 3 : 0;
+	if (0 == ece391_strcmp (arg, (uint8_t*)"sink"))
+	    return sink ();
+	ece391_fdputs (1, (uint8_t*)"usage: pipebench [gen|sink]\n");
+	return 3;
+    }
+
+    if (-1 == ece391_pipe (fds)) {
+	ece391_fdputs (1, (uint8_t*)"pipe failed\n");
+	return 3;
+    }
+
+    /* the sink gets the read end as stdin, and nothing else of the pipe */
+    ece391_dup2 (0, SAVE_FD);
+    ece391_dup2 (fds[0], 0);
+    pid = ece391_spawn ((uint8_t*)"pipebench sink");
+    ece391_dup2 (SAVE_FD, 0);
+    ece391_close (SAVE_FD);
+    ece391_close (fds[0]);
+    if (-1 == pid) {
+	ece391_fdputs (1, (uint8_t*)"could not start sink\n");
+	return 3;
+    }
+
+    start = rdtsc ();
+    if (-1 == gen (fds[1]))
+	ece391_fdputs (1, (uint8_t*)"pipe write failed\n");
+    ece391_close (fds[1]);
+    ece391_wait (pid, &status, 0);
+    cycles = rdtsc () - start;
+
+    report ("pipe: ", per_kb (cycles, BENCH_BYTES), " cycles/KB end to end\n");
+    return status;
+}
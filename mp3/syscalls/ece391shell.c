@@ -4,14 +4,80 @@
 #include "ece391syscall.h"
 
 #define BUFSIZE 1024
+#define NUMSIZE 12
+#define SAVE_FD 7 /* holds the shell's own stdin or stdout during a pipeline */
+
+/* Prints "[pid] " and then msg */
+static void
+job_message (int32_t pid, const char* msg)
+{
+    uint8_t num[NUMSIZE];
+
+    ece391_itoa (pid, num, 10);
+    ece391_fdputs (1, (uint8_t*)"[");
+    ece391_fdputs (1, num);
+    ece391_fdputs (1, (uint8_t*)"] ");
+    ece391_fdputs (1, (uint8_t*)msg);
+}
+
+/* Reaps background jobs that have finished, without waiting for the rest */
+static void
+reap_jobs ()
+{
+    int32_t pid, status;
+
+    while (0 < (pid = ece391_wait (-1, &status, ECE391_WNOHANG))) {
+	if (0 == status)
+	    job_message (pid, "done\n");
+	else
+	    job_message (pid, "terminated abnormally\n");
+    }
+}
+
+/*
+ * Runs "left | right": left is spawned with its stdout on a pipe, and
+ * right runs in the foreground reading it as stdin.  Returns the status
+ * of right like execute, -1 if either could not start.
+ */
+static int32_t
+run_pipeline (uint8_t* left, uint8_t* right)
+{
+    int32_t fds[2];
+    int32_t pid, rval, status;
+
+    if (-1 == ece391_pipe (fds))
+	return -1;
+
+    /* left gets the write end, and right must not, or it never sees the end */
+    ece391_dup2 (1, SAVE_FD);
+    ece391_dup2 (fds[1], 1);
+    pid = ece391_spawn (left);
+    ece391_dup2 (SAVE_FD, 1);
+    ece391_close (fds[1]);
+
+    ece391_dup2 (0, SAVE_FD);
+    ece391_dup2 (fds[0], 0);
+    ece391_close (fds[0]);
+    rval = (-1 == pid) ? -1 : ece391_execute (right);
+    ece391_dup2 (SAVE_FD, 0);
+    ece391_close (SAVE_FD);
+
+    /* left may still be writing if right stopped early, but the pipe is gone now */
+    if (-1 != pid)
+	ece391_wait (pid, &status, 0);
+    return rval;
+}
 
 int main ()
 {
-    int32_t cnt, rval;
+    int32_t cnt, rval, background;
+    uint8_t* bar;
+    uint8_t* right;
     uint8_t buf[BUFSIZE];
     ece391_fdputs (1, (uint8_t*)"Starting 391 Shell\n");
 
     while (1) {
+	reap_jobs ();
         ece391_fdputs (1, (uint8_t*)"391OS> ");
 	if (-1 == (cnt = ece391_read (0, buf, BUFSIZE-1))) {
 	    ece391_fdputs (1, (uint8_t*)"read from keyboard failed\n");
@@ -24,7 +90,34 @@ int main ()
 	    return 0;
 	if ('\0' == buf[0])
 	    continue;
-	rval = ece391_execute (buf);
+
+	/* a trailing & runs the command in the background */
+	while (cnt > 0 && ' ' == buf[cnt - 1])
+	    buf[--cnt] = '\0';
+	background = (cnt > 0 && '&' == buf[cnt - 1]);
+	if (background) {
+	    buf[--cnt] = '\0';
+	    while (cnt > 0 && ' ' == buf[cnt - 1])
+		buf[--cnt] = '\0';
+	    if (-1 == (rval = ece391_spawn (buf)))
+		ece391_fdputs (1, (uint8_t*)"no such command\n");
+	    else
+		job_message (rval, "started\n");
+	    continue;
+	}
+
+	/* "a | b" pipes the output of a into b */
+	for (bar = buf; '\0' != *bar && '|' != *bar; bar++);
+	if ('|' == *bar) {
+	    right = bar + 1;
+	    while (' ' == *right)
+		right++;
+	    *bar = '\0';
+	    while (bar > buf && ' ' == bar[-1])
+		*--bar = '\0';
+	    rval = run_pipeline (buf, right);
+	} else
+	    rval = ece391_execute (buf);
 	if (-1 == rval)
 	    ece391_fdputs (1, (uint8_t*)"no such command\n");
 	else if (256 == rval)
@@ -21,6 +21,24 @@ void ece391_fdputs(int32_t fd, const uint8_t* s)
     (void)ece391_write (fd, s, ece391_strlen(s));
 }
 
+/* Writes n strings with one system call per ECE391_IOV_MAX strings */
+void ece391_fdputsv(int32_t fd, const uint8_t* const* s, int32_t n)
+{
+    ece391_iovec_t iov[ECE391_IOV_MAX];
+    int32_t i, cnt;
+
+    while (n > 0) {
+        cnt = (n < ECE391_IOV_MAX) ? n : ECE391_IOV_MAX;
+        for (i = 0; i < cnt; i++) {
+            iov[i].base = (void*)s[i];
+            iov[i].len = ece391_strlen(s[i]);
+        }
+        (void)ece391_writev (fd, iov, cnt);
+        s += cnt;
+        n -= cnt;
+    }
+}
+
 int32_t ece391_strcmp(const uint8_t* s1, const uint8_t* s2)
 {
     while (*s1 == *s2) {
@@ -102,3 +120,11 @@ uint8_t* ece391_strrev(uint8_t* s)
    return s;
 }
 
+int32_t ece391_fsize(int32_t fd)
+{
+    ece391_stat_t st;
+
+    if (0 != ece391_fstat (fd, &st) || 2 != st.type)
+        return -1;
+    return st.length;
+}
@@ -0,0 +1,69 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+#include "ece391sysnum.h"
+
+#define ROUNDS 10000
+#define BUFSIZE 16
+
+/*
+ * Null system call benchmark.  close(-1) fails on its first check, so
+ * the time per call is almost all entry and exit.  Compares INT 0x80
+ * with the SYSENTER path the library wrappers use.
+ */
+
+static inline uint32_t
+rdtsc (void)
+{
+    uint32_t val;
+    asm volatile ("rdtsc" : "=a"(val) : : "edx");
+    return val;
+}
+
+/* close(fd) through INT 0x80 and system_call_handler */
+static int32_t
+int80_close (int32_t fd)
+{
+    int32_t ret;
+    asm volatile ("int $0x80"
+		  : "=a"(ret)
+		  : "a"(SYS_CLOSE), "b"(fd)
+		  : "ecx", "edx", "memory", "cc");
+    return ret;
+}
+
+static void
+report (const char* name, uint32_t cycles)
+{
+    uint8_t buf[BUFSIZE];
+
+    ece391_fdputs (1, (uint8_t*)name);
+    ece391_itoa (cycles / ROUNDS, buf, 10);
+    ece391_fdputs (1, buf);
+    ece391_fdputs (1, (uint8_t*)" cycles/call\n");
+}
+
+int main ()
+{
+    uint32_t i, start, int80, fast;
+
+    // warm up both paths
+    (void)int80_close (-1);
+    (void)ece391_close (-1);
+
+    start = rdtsc ();
+    for (i = 0; i < ROUNDS; i++)
+	(void)int80_close (-1);
+    int80 = rdtsc () - start;
+
+    start = rdtsc ();
+    for (i = 0; i < ROUNDS; i++)
+	(void)ece391_close (-1);
+    fast = rdtsc () - start;
+
+    report ("int 0x80: ", int80);
+    report ("sysenter: ", fast);
+
+    return 0;
+}
@@ -19,9 +19,180 @@ extern int32_t ece391_open (const uint8_t* filename);
 extern int32_t ece391_close (int32_t fd);
 extern int32_t ece391_getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t ece391_vidmap (uint8_t** screen_start);
+
+/*
+ * set_handler makes handler(signum) run when the signal arrives, or
+ * restores the default action if handler is NULL.  DIV_ZERO, SEGFAULT
+ * and INTERRUPT (ctrl+c) kill the program by default, so execute
+ * returns 256; ALARM and USER1 are ignored.  A handler runs with other
+ * signals held off and returns into code on the stack that calls
+ * sigreturn, which resumes the program with the saved registers.
+ */
 extern int32_t ece391_set_handler (int32_t signum, void* handler);
 extern int32_t ece391_sigreturn (void);
 
+/*
+ * Sends ALARM every ms milliseconds, rounded up to the 10 ms timer tick,
+ * starting from now.  0 stops it.  Programs start with a 10 second
+ * alarm.
+ */
+extern int32_t ece391_alarm (int32_t ms);
+
+/*
+ * Sleeps for at least ms milliseconds, rounded up to the 10 ms timer
+ * tick, without using the CPU.  Returns -1 if a signal with a handler
+ * (or one that kills) ends the sleep early.
+ */
+extern int32_t ece391_sleep (int32_t ms);
+
+/*
+ * Counts of 10 ms timer ticks since boot, and of the ones that found
+ * the CPU idle because no program could run.  The difference between
+ * two calls gives the CPU utilization over that time.  max_gap is the
+ * longest time between two timer ticks since the previous call, in
+ * rdtsc cycles; anything past 10 ms of it is interrupt latency.
+ * load_max_gap only counts ticks that came in while execute or spawn
+ * was loading a program image.
+ */
+typedef struct ece391_cpustat {
+	uint32_t ticks;
+	uint32_t idle_ticks;
+	uint32_t max_gap;
+	uint32_t load_max_gap;
+} ece391_cpustat_t;
+extern int32_t ece391_cpustat (ece391_cpustat_t* buf);
+
+/*
+ * Maps an open file read-only into the caller's address space.  Returns
+ * the file length and writes the start of the mapping to *start.  The
+ * mapping lasts until the program halts.
+ */
+extern int32_t ece391_mmap (int32_t fd, uint8_t** start);
+
+/* 
+ * Record filled in by ece391_getdents, one per directory entry.  The
+ * name is not NUL-terminated when it is 32 characters long.  Type is 0
+ * for the RTC, 1 for a directory, 2 for a regular file and 3 for the
+ * callstats file; inode and length are 0 unless the entry is a regular
+ * file.
+ */
+typedef struct ece391_dirent {
+	uint8_t name[32];
+	uint32_t type;
+	uint32_t inode;
+	uint32_t length;
+} ece391_dirent_t;
+
+/*
+ * Fills buf with as many directory records as fit in nbytes.  Returns
+ * the number of bytes filled, or 0 once the directory is exhausted.
+ */
+extern int32_t ece391_getdents (int32_t fd, ece391_dirent_t* buf, int32_t nbytes);
+
+/*
+ * Record filled in by ece391_stat and ece391_fstat.  Type matches
+ * ece391_dirent_t; inode, length and blocks are 0 unless the file is a
+ * regular file.
+ */
+typedef struct ece391_stat {
+	uint32_t type;
+	uint32_t inode;
+	uint32_t length;
+	uint32_t blocks;
+} ece391_stat_t;
+
+/* Look up a file by name or by open descriptor.  Return 0 on success. */
+extern int32_t ece391_stat (const uint8_t* filename, ece391_stat_t* buf);
+extern int32_t ece391_fstat (int32_t fd, ece391_stat_t* buf);
+
+/*
+ * Record read from the "callstats" file, one per system call each pid has
+ * made.  A pid's records cover the program that holds the pid now, or
+ * held it last, since start_tick (in 10 ms timer ticks since boot).
+ * Records with pid 0 add up the earlier programs whose pid was reused.
+ * Calls are counted on entry; cycles and the log2 histogram (hist[i]
+ * counts calls of 2^i to 2^(i+1)-1 TSC cycles, the last bucket also
+ * takes anything longer) cover calls that returned.
+ */
+#define ECE391_SYSSTAT_BUCKETS 32
+typedef struct ece391_sysstat {
+	uint32_t pid;
+	uint32_t syscall;
+	uint32_t start_tick;
+	uint32_t count;
+	uint64_t cycles;
+	uint32_t hist[ECE391_SYSSTAT_BUCKETS];
+} ece391_sysstat_t;
+
+/*
+ * Moves the read position of an open regular file and returns the new
+ * position.  Seeking before the start or past the end of the file fails.
+ */
+#define ECE391_SEEK_SET 0
+#define ECE391_SEEK_CUR 1
+#define ECE391_SEEK_END 2
+extern int32_t ece391_lseek (int32_t fd, int32_t offset, int32_t whence);
+
+/* 
+ * Reads from the given offset of an open regular file without moving
+ * its read position.  Returns 0 at or past the end of the file.
+ */
+extern int32_t ece391_pread (int32_t fd, void* buf, int32_t nbytes, uint32_t offset);
+
+/*
+ * Reads into or writes out several buffers, in order, with one system
+ * call.  At most ECE391_IOV_MAX buffers per call.  Return the total
+ * number of bytes transferred; readv stops at the first buffer it could
+ * not fill.
+ */
+#define ECE391_IOV_MAX 16
+typedef struct ece391_iovec {
+	void* base;
+	int32_t len;
+} ece391_iovec_t;
+extern int32_t ece391_readv (int32_t fd, const ece391_iovec_t* iov, int32_t iovcnt);
+extern int32_t ece391_writev (int32_t fd, const ece391_iovec_t* iov, int32_t iovcnt);
+
+/*
+ * Waits until at least one descriptor in fds is ready for the events it
+ * asks for, or until timeout milliseconds pass (0 only checks, negative
+ * waits forever).  Fills in revents and returns the number of ready
+ * descriptors, 0 on timeout.  The RTC is ready once per virtual tick and
+ * stdin once enter is pressed; files are always ready.
+ */
+#define ECE391_POLLIN  0x1
+#define ECE391_POLLOUT 0x4
+typedef struct ece391_pollfd {
+	int32_t fd;
+	int16_t events;
+	int16_t revents;
+} ece391_pollfd_t;
+extern int32_t ece391_poll (ece391_pollfd_t* fds, int32_t nfds, int32_t timeout);
+
+/*
+ * spawn starts a program like execute, but returns its pid at once and
+ * runs it alongside the caller.  wait reaps a spawned child (pid, or any
+ * with -1) once it halts, storing its halt status if status is not NULL,
+ * and returns its pid.  With ECE391_WNOHANG wait returns 0 instead of
+ * blocking; it returns -1 if there is no such child to wait for.
+ */
+#define ECE391_WNOHANG 0x1
+extern int32_t ece391_spawn (const uint8_t* command);
+extern int32_t ece391_wait (int32_t pid, int32_t* status, int32_t flags);
+
+/*
+ * pipe opens a pipe, with the read end in fds[0] and the write end in
+ * fds[1].  Reads wait for data and return 0 once every write end is
+ * closed; writes wait for room and fail once every read end is closed.
+ * Programs started by execute or spawn inherit the caller's open
+ * descriptors, except the two from pipe.  dup2 makes newfd a copy of
+ * oldfd (closing newfd first) that is inherited, so a pipe end dup2'd
+ * onto 0 or 1 becomes the stdin or stdout of the next program started.
+ * dup2 returns newfd.
+ */
+extern int32_t ece391_pipe (int32_t fds[2]);
+extern int32_t ece391_dup2 (int32_t oldfd, int32_t newfd);
+
 enum signums {
 	DIV_ZERO = 0,
 	SEGFAULT,
@@ -11,5 +11,21 @@
 #define SYS_VIDMAP  8
 #define SYS_SET_HANDLER  9
 #define SYS_SIGRETURN  10
+#define SYS_MMAP    11
+#define SYS_GETDENTS 12
+#define SYS_STAT    13
+#define SYS_FSTAT   14
+#define SYS_LSEEK   15
+#define SYS_PREAD   16
+#define SYS_READV   17
+#define SYS_WRITEV  18
+#define SYS_POLL    19
+#define SYS_SPAWN   20
+#define SYS_WAIT    21
+#define SYS_PIPE    22
+#define SYS_DUP2    23
+#define SYS_ALARM   24
+#define SYS_SLEEP   25
+#define SYS_CPUSTAT 26
 
 #endif /* ECE391SYSNUM_H */
@@ -0,0 +1,151 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+#include "ece391sysnum.h"
+
+#define NRECORDS 8
+#define NPIDS 16
+#define LINELEN 256
+
+/*
+ * Pretty-prints the "callstats" file: calls and average cycles for each
+ * system call of each pid, then the totals with a log2 latency
+ * histogram per system call.  A pid's lines cover its latest program,
+ * started at the tick shown; "old" sums up programs whose pid was
+ * reused since.
+ */
+
+static const char* names[SYS_CPUSTAT + 1] = {
+    "?", "halt", "execute", "read", "write", "open", "close", "getargs",
+    "vidmap", "set_handler", "sigreturn", "mmap", "getdents", "stat",
+    "fstat", "lseek", "pread", "readv", "writev", "poll", "spawn", "wait",
+    "pipe", "dup2", "alarm", "sleep", "cpustat"
+};
+
+static ece391_sysstat_t totals[SYS_CPUSTAT + 1];
+
+/* n / d without the 64-bit division helpers from libgcc */
+static uint32_t
+div64 (uint64_t n, uint32_t d)
+{
+    uint64_t q = 0, r = 0;
+    int32_t bit;
+
+    if (d == 0)
+	return 0;
+    for (bit = 63; bit >= 0; bit--) {
+	r = (r << 1) | ((n >> bit) & 1);
+	if (r >= d) {
+	    r -= d;
+	    q |= (uint64_t)1 << bit;
+	}
+    }
+    return (q >> 32) ? 0xFFFFFFFF : (uint32_t)q;
+}
+
+/* Appends s to line, padded with spaces to width, right-aligned if right */
+static void
+put_field (uint8_t* line, int32_t* len, const uint8_t* s, int32_t width, int32_t right)
+{
+    int32_t n = ece391_strlen (s);
+
+    for (; right && n < width && *len < LINELEN - 1; width--)
+	line[(*len)++] = ' ';
+    for (; *s != '\0' && *len < LINELEN - 1; s++, width--)
+	line[(*len)++] = *s;
+    for (; width > 0 && *len < LINELEN - 1; width--)
+	line[(*len)++] = ' ';
+    line[*len] = '\0';
+}
+
+static void
+put_num (uint8_t* line, int32_t* len, uint32_t value, int32_t width)
+{
+    uint8_t buf[16];
+
+    ece391_itoa (value, buf, 10);
+    put_field (line, len, buf, width, 1);
+}
+
+/* Writes "calls avg" for one record after the name already in line */
+static void
+put_counts (uint8_t* line, int32_t* len, const ece391_sysstat_t* rec)
+{
+    uint32_t returned = 0;
+    int32_t i;
+
+    for (i = 0; i < ECE391_SYSSTAT_BUCKETS; i++)
+	returned += rec->hist[i];
+    put_num (line, len, rec->count, 9);
+    put_num (line, len, div64 (rec->cycles, returned), 12);
+}
+
+int main ()
+{
+    ece391_sysstat_t records[NRECORDS];
+    uint8_t line[LINELEN];
+    int32_t fd, cnt, len, i, j;
+    ece391_sysstat_t* rec;
+
+    if (-1 == (fd = ece391_open ((uint8_t*)"callstats"))) {
+        ece391_fdputs (1, (uint8_t*)"callstats open failed\n");
+        return 2;
+    }
+
+    ece391_fdputs (1, (uint8_t*)"pid since tick call             calls  avg cycles\n");
+    while (0 != (cnt = ece391_read (fd, records, sizeof (records)))) {
+	if (-1 == cnt) {
+	    ece391_fdputs (1, (uint8_t*)"callstats read failed\n");
+	    return 3;
+	}
+	for (i = 0; i < cnt / (int32_t)sizeof (ece391_sysstat_t); i++) {
+	    rec = &records[i];
+	    if (rec->syscall > SYS_CPUSTAT)
+		continue;
+
+	    len = 0;
+	    if (0 == rec->pid) {
+		put_field (line, &len, (uint8_t*)"old", 3, 1);
+		put_field (line, &len, (uint8_t*)"", 11, 0);
+	    } else {
+		put_num (line, &len, rec->pid, 3);
+		put_num (line, &len, rec->start_tick, 11);
+	    }
+	    put_field (line, &len, (uint8_t*)" ", 1, 0);
+	    put_field (line, &len, (uint8_t*)names[rec->syscall], 12, 0);
+	    put_counts (line, &len, rec);
+	    put_field (line, &len, (uint8_t*)"\n", 1, 0);
+	    ece391_fdputs (1, line);
+
+	    totals[rec->syscall].count += rec->count;
+	    totals[rec->syscall].cycles += rec->cycles;
+	    for (j = 0; j < ECE391_SYSSTAT_BUCKETS; j++)
+		totals[rec->syscall].hist[j] += rec->hist[j];
+	}
+    }
+    ece391_close (fd);
+
+    ece391_fdputs (1, (uint8_t*)"\nall            call             calls  avg cycles  log2 cycles:calls\n");
+    for (i = 1; i <= SYS_CPUSTAT; i++) {
+	if (totals[i].count == 0)
+	    continue;
+	len = 0;
+	put_field (line, &len, (uint8_t*)"", 15, 0);
+	put_field (line, &len, (uint8_t*)names[i], 12, 0);
+	put_counts (line, &len, &totals[i]);
+	put_field (line, &len, (uint8_t*)" ", 1, 0);
+	for (j = 0; j < ECE391_SYSSTAT_BUCKETS; j++) {
+	    if (totals[i].hist[j] == 0)
+		continue;
+	    put_field (line, &len, (uint8_t*)" ", 1, 0);
+	    put_num (line, &len, j, 0);
+	    put_field (line, &len, (uint8_t*)":", 1, 0);
+	    put_num (line, &len, totals[i].hist[j], 0);
+	}
+	put_field (line, &len, (uint8_t*)"\n", 1, 0);
+	ece391_fdputs (1, line);
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * bigdirfs - adds thousands of generated files to a file system image and
+ * stores the whole directory in the extended format read by
+ * student-distrib/filesys.c, for testing and benchmarking large
+ * directories.
+ *
+ * Usage: bigdirfs <input image> <output image> [count]
+ *
+ * count files named bigdirNNNNN.txt (5000 by default) are appended after
+ * the image's own entries.  Each inode takes a whole 4 KiB block and the
+ * module has to fit below the first process's memory at 12 MB, so the new
+ * files share a pool of at most POOL_INODES small inodes.
+ *
+ * The directory is written after the data blocks: dir_blocks blocks of
+ * packed dentries, then dir_hash_size 32-bit hash slots.  Each slot holds
+ * entry index + 1 (0 when empty) and entries are placed by linear probing
+ * from the FNV-1a hash of their name.  The boot block keeps the first 63
+ * entries so kernels without extended directory support still boot.
+ */
+
+#include "fsimage.h"
+
+#define POOL_INODES 64
+#define DEFAULT_COUNT 5000
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    uint8_t *image, *out, *entries, *entry, *block;
+    uint32_t *boot, *new_boot, *hash, *node;
+    uint32_t image_size, count, pool, total, inodes, datablocks;
+    uint32_t dir_blocks, hash_size, hash_blocks, out_blocks;
+    uint32_t i, slot;
+
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr, "usage: %s <input image> <output image> [count]\n", argv[0]);
+        return 1;
+    }
+    count = (argc == 4) ? strtoul(argv[3], NULL, 10) : DEFAULT_COUNT;
+    if (count == 0 || count > 99999) {
+        fprintf(stderr, "count must be between 1 and 99999\n");
+        return 1;
+    }
+
+    if (NULL == (image = load_image(argv[1], &image_size)))
+        return 1;
+
+    boot = (uint32_t *)image;
+    inodes = boot[BOOT_NUM_INODES];
+    datablocks = boot[BOOT_NUM_DATABLOCKS];
+    if (boot[BOOT_NUM_ENTRIES] > DENTRY_COUNT || (uint64_t)BLOCK_SIZE * (1 + inodes + datablocks) > image_size) {
+        fprintf(stderr, "%s: bad boot block\n", argv[1]);
+        return 1;
+    }
+    if (boot[BOOT_DIR_MAGIC] == DIR_MAGIC) {
+        fprintf(stderr, "%s: image already has an extended directory\n", argv[1]);
+        return 1;
+    }
+
+    pool = (count < POOL_INODES) ? count : POOL_INODES;
+    total = boot[BOOT_NUM_ENTRIES] + count;
+    dir_blocks = (total * DENTRY_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (hash_size = 1; hash_size < 2 * total; hash_size <<= 1);
+    hash_blocks = (hash_size * sizeof(uint32_t) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    out_blocks = 1 + inodes + pool + datablocks + pool + dir_blocks + hash_blocks;
+
+    out = calloc(out_blocks, BLOCK_SIZE);
+    if (out == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    /* boot block, old inodes, new inodes, old data, new data */
+    memcpy(out, image, BLOCK_SIZE);
+    memcpy(out + BLOCK_SIZE, image + BLOCK_SIZE, (uint64_t)inodes * BLOCK_SIZE);
+    memcpy(out + BLOCK_SIZE * (1 + inodes + pool), image + BLOCK_SIZE * (1 + inodes),
+           (uint64_t)datablocks * BLOCK_SIZE);
+    for (i = 0; i < pool; i++) {
+        node = (uint32_t *)(out + BLOCK_SIZE * (1 + inodes + i));
+        block = out + BLOCK_SIZE * (1 + inodes + pool + datablocks + i);
+        node[0] = sprintf((char *)block, "generated file from inode pool slot %u\n", i);
+        node[1] = datablocks + i;
+    }
+
+    /* directory: the image's own entries, then the generated ones */
+    entries = out + BLOCK_SIZE * (1 + inodes + pool + datablocks + pool);
+    memcpy(entries, image + 64, boot[BOOT_NUM_ENTRIES] * DENTRY_SIZE);
+    for (i = 0; i < count; i++) {
+        entry = entries + (boot[BOOT_NUM_ENTRIES] + i) * DENTRY_SIZE;
+        snprintf((char *)entry, FNAME_MAX_LEN, "bigdir%05u.txt", i);
+        ((uint32_t *)entry)[DENTRY_TYPE] = TYPE_FILE;
+        ((uint32_t *)entry)[DENTRY_INODE] = inodes + i % pool;
+    }
+
+    hash = (uint32_t *)(entries + dir_blocks * BLOCK_SIZE);
+    for (i = 0; i < total; i++) {
+        slot = dentry_hash(entries + i * DENTRY_SIZE) & (hash_size - 1);
+        while (hash[slot] != 0)
+            slot = (slot + 1) & (hash_size - 1);
+        hash[slot] = i + 1;
+    }
+
+    new_boot = (uint32_t *)out;
+    new_boot[BOOT_NUM_INODES] = inodes + pool;
+    new_boot[BOOT_NUM_DATABLOCKS] = datablocks + pool;
+    new_boot[BOOT_DIR_MAGIC] = DIR_MAGIC;
+    new_boot[BOOT_DIR_ENTRIES] = total;
+    new_boot[BOOT_DIR_BLOCKS] = dir_blocks;
+    new_boot[BOOT_DIR_HASH_SIZE] = hash_size;
+
+    if (NULL == (f = fopen(argv[2], "wb"))
+        || fwrite(out, BLOCK_SIZE, out_blocks, f) != out_blocks
+        || fclose(f) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("%u entries (%u generated on %u inodes), %u directory blocks, %u hash slots, %u bytes\n",
+           total, count, pool, dir_blocks, hash_size, out_blocks * BLOCK_SIZE);
+    return 0;
+}
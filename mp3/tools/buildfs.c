@@ -0,0 +1,219 @@
+/*
+ * buildfs - builds a file system image from a flat directory, like the
+ * prebuilt createfs, but with a layout chosen for sequential reads.
+ *
+ * Usage: buildfs [-h hot,files,...] <source dir> <output image>
+ *
+ * Files are given inode numbers in order and each file's data blocks are
+ * placed contiguously right after the previous file's, so read_data can
+ * copy a whole file with a single memcpy.  The hot files (shell, ls and
+ * cat unless -h says otherwise) come first, then the remaining
+ * executables, then everything else, each group sorted by name.  The
+ * directory lists ".", "rtc" and "callstats" (the system call statistics
+ * file sysstat reads) first, then the files in inode order.
+ * More than 63 entries are stored in the extended directory format (see
+ * bigdirfs).  A layout report goes to stdout.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "fsimage.h"
+
+#define DEFAULT_HOT "shell,ls,cat"
+#define MAX_FILES 4096
+#define SPECIAL_ENTRIES 3              /* ".", "rtc" and "callstats" */
+
+typedef struct file {
+    char name[FNAME_MAX_LEN + 1];   /* truncated to 32 characters like createfs */
+    char *path;
+    uint32_t length;
+    int rank;                       /* position in the hot list, then 1000 for executables, 2000 others */
+} file_t;
+
+static file_t files[MAX_FILES];
+
+static int file_order(const void *a, const void *b)
+{
+    const file_t *fa = a, *fb = b;
+
+    if (fa->rank != fb->rank)
+        return fa->rank - fb->rank;
+    return strcmp(fa->name, fb->name);
+}
+
+static int hot_rank(const char *hot, const char *name)
+{
+    int rank = 0;
+    size_t len = strlen(name);
+
+    while (*hot != '\0') {
+        if (strncmp(hot, name, len) == 0 && (hot[len] == ',' || hot[len] == '\0'))
+            return rank;
+        rank++;
+        hot = strchr(hot, ',');
+        if (hot == NULL)
+            break;
+        hot++;
+    }
+    return -1;
+}
+
+static void put_dentry(uint8_t *entry, const char *name, uint32_t type, uint32_t inode)
+{
+    size_t len = strlen(name);
+
+    memcpy(entry, name, len < FNAME_MAX_LEN ? len : FNAME_MAX_LEN);
+    ((uint32_t *)entry)[DENTRY_TYPE] = type;
+    ((uint32_t *)entry)[DENTRY_INODE] = inode;
+}
+
+int main(int argc, char **argv)
+{
+    const char *hot = DEFAULT_HOT;
+    DIR *dir;
+    struct dirent *de;
+    struct stat st;
+    FILE *f;
+    uint8_t *out, *entries, magic[4];
+    uint32_t *boot, *node, *hash;
+    uint32_t nfiles = 0, nentries, datablocks = 0, blocks, first;
+    uint32_t dir_blocks = 0, hash_size = 0, hash_blocks = 0, out_blocks;
+    uint32_t i, j, slot;
+    int rank;
+
+    if (argc == 5 && strcmp(argv[1], "-h") == 0) {
+        hot = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s [-h hot,files,...] <source dir> <output image>\n", argv[0]);
+        return 1;
+    }
+
+    if (NULL == (dir = opendir(argv[1]))) {
+        perror(argv[1]);
+        return 1;
+    }
+    while (NULL != (de = readdir(dir))) {
+        if (nfiles == MAX_FILES) {
+            fprintf(stderr, "%s: more than %d files\n", argv[1], MAX_FILES);
+            return 1;
+        }
+        files[nfiles].path = malloc(strlen(argv[1]) + strlen(de->d_name) + 2);
+        sprintf(files[nfiles].path, "%s/%s", argv[1], de->d_name);
+        if (stat(files[nfiles].path, &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+        if (st.st_size > (off_t)INODE_BLOCKS * BLOCK_SIZE) {
+            fprintf(stderr, "%s: too large\n", files[nfiles].path);
+            return 1;
+        }
+        if (strlen(de->d_name) > FNAME_MAX_LEN)
+            fprintf(stderr, "warning: %s truncated to 32 characters\n", de->d_name);
+        snprintf(files[nfiles].name, sizeof(files[nfiles].name), "%.32s", de->d_name);
+        files[nfiles].length = st.st_size;
+
+        rank = hot_rank(hot, files[nfiles].name);
+        if (rank < 0) {
+            rank = 2000;
+            if (NULL != (f = fopen(files[nfiles].path, "rb"))) {
+                if (fread(magic, 1, 4, f) == 4 && memcmp(magic, "\177ELF", 4) == 0)
+                    rank = 1000;
+                fclose(f);
+            }
+        }
+        files[nfiles].rank = rank;
+        nfiles++;
+    }
+    closedir(dir);
+
+    qsort(files, nfiles, sizeof(file_t), file_order);
+    for (i = 0; i < nfiles; i++) {
+        for (j = 0; j <= i; j++) {
+            if ((j < i && strcmp(files[i].name, files[j].name) == 0) ||
+                strcmp(files[i].name, ".") == 0 || strcmp(files[i].name, "rtc") == 0 ||
+                strcmp(files[i].name, "callstats") == 0) {
+                fprintf(stderr, "duplicate name %s\n", files[i].name);
+                return 1;
+            }
+        }
+    }
+
+    for (i = 0; i < nfiles; i++)
+        datablocks += (files[i].length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    nentries = nfiles + SPECIAL_ENTRIES;
+    if (nentries > DENTRY_COUNT) {
+        dir_blocks = (nentries * DENTRY_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        for (hash_size = 1; hash_size < 2 * nentries; hash_size <<= 1);
+        hash_blocks = (hash_size * sizeof(uint32_t) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+    out_blocks = 1 + nfiles + datablocks + dir_blocks + hash_blocks;
+    out = calloc(out_blocks, BLOCK_SIZE);
+    entries = malloc(nentries * DENTRY_SIZE);
+    if (out == NULL || entries == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    memset(entries, 0, nentries * DENTRY_SIZE);
+
+    put_dentry(entries, ".", TYPE_DIR, 0);
+    put_dentry(entries + DENTRY_SIZE, "rtc", TYPE_RTC, 0);
+    put_dentry(entries + DENTRY_SIZE * 2, "callstats", TYPE_SYSSTAT, 0);
+
+    printf("%-32s %5s %7s %6s %6s\n", "name", "inode", "bytes", "first", "blocks");
+    first = 0;
+    for (i = 0; i < nfiles; i++) {
+        node = (uint32_t *)(out + BLOCK_SIZE * (1 + i));
+        blocks = (files[i].length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        node[0] = files[i].length;
+        for (j = 0; j < blocks; j++)
+            node[1 + j] = first + j;
+
+        if (NULL == (f = fopen(files[i].path, "rb")) ||
+            fread(out + BLOCK_SIZE * (1 + nfiles + first), 1, files[i].length, f) != files[i].length) {
+            fprintf(stderr, "%s: could not read\n", files[i].path);
+            return 1;
+        }
+        fclose(f);
+
+        put_dentry(entries + DENTRY_SIZE * (SPECIAL_ENTRIES + i), files[i].name, TYPE_FILE, i);
+        printf("%-32s %5u %7u %6u %6u%s\n", files[i].name, i, files[i].length, first, blocks,
+               files[i].rank < 1000 ? "  hot" : "");
+        first += blocks;
+    }
+
+    boot = (uint32_t *)out;
+    boot[BOOT_NUM_ENTRIES] = nentries < DENTRY_COUNT ? nentries : DENTRY_COUNT;
+    boot[BOOT_NUM_INODES] = nfiles;
+    boot[BOOT_NUM_DATABLOCKS] = datablocks;
+    memcpy(out + DENTRY_SIZE, entries, boot[BOOT_NUM_ENTRIES] * DENTRY_SIZE);
+
+    if (dir_blocks != 0) {
+        memcpy(out + BLOCK_SIZE * (1 + nfiles + datablocks), entries, nentries * DENTRY_SIZE);
+        hash = (uint32_t *)(out + BLOCK_SIZE * (1 + nfiles + datablocks + dir_blocks));
+        for (i = 0; i < nentries; i++) {
+            slot = dentry_hash(entries + i * DENTRY_SIZE) & (hash_size - 1);
+            while (hash[slot] != 0)
+                slot = (slot + 1) & (hash_size - 1);
+            hash[slot] = i + 1;
+        }
+        boot[BOOT_DIR_MAGIC] = DIR_MAGIC;
+        boot[BOOT_DIR_ENTRIES] = nentries;
+        boot[BOOT_DIR_BLOCKS] = dir_blocks;
+        boot[BOOT_DIR_HASH_SIZE] = hash_size;
+    }
+
+    if (NULL == (f = fopen(argv[2], "wb"))
+        || fwrite(out, BLOCK_SIZE, out_blocks, f) != out_blocks
+        || fclose(f) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("%u entries, %u inodes, %u data blocks%s, %u bytes, every file contiguous\n",
+           nentries, nfiles, datablocks, dir_blocks ? " + extended directory" : "",
+           out_blocks * BLOCK_SIZE);
+    return 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * compressfs - converts a file system image made by createfs into the
+ * compressed format read by student-distrib/filesys.c.
+ *
+ * Usage: compressfs <input image> <output image>
+ *
+ * Every file whose data shrinks is stored with INODE_COMPRESSED set in its
+ * inode length.  Its blocks are LZ compressed one at a time (see lz_decode
+ * in student-distrib/blockcache.c for the encoding) and packed back to back
+ * after the uncompressed files' blocks.  data_blocks[i] then holds the byte
+ * offset of encoded block i from the start of the data blocks, and
+ * data_blocks[i + 1] marks where it ends.  A block that does not shrink is
+ * stored raw, which the kernel tells apart by its encoded size equalling
+ * its decoded size.  Files keep their inode numbers and directory entries,
+ * and an extended directory (see bigdirfs) moves along with the end of the
+ * data blocks.
+ */
+
+#include "fsimage.h"
+
+#define HASH_BITS 12
+#define MAX_OFFSET 65535
+
+static uint8_t *image;
+static uint32_t image_size;
+static uint32_t num_inodes, num_datablocks;
+
+static uint32_t *inode_words(uint32_t inode)
+{
+    return (uint32_t *)(image + BLOCK_SIZE * (inode + 1));
+}
+
+static uint8_t *data_block(uint32_t block)
+{
+    return image + BLOCK_SIZE * (block + num_inodes + 1);
+}
+
+/* Writes a literal or match length extension; returns bytes written or 0 if out of room */
+static uint32_t put_length(uint8_t *dst, uint32_t room, uint32_t count)
+{
+    uint32_t n = 0;
+
+    for (; count >= 255; count -= 255) {
+        if (n >= room)
+            return 0;
+        dst[n++] = 255;
+    }
+    if (n >= room)
+        return 0;
+    dst[n++] = count;
+    return n;
+}
+
+/*
+ * Greedy LZ encoder matching lz_decode.  Returns the encoded size, or 0 if
+ * the result would not be smaller than cap bytes.
+ */
+static uint32_t lz_encode(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t cap)
+{
+    int32_t table[1 << HASH_BITS];
+    uint32_t i = 0, anchor = 0, out = 0;
+    uint32_t lits, mlen, n, word, h;
+    int32_t cand;
+
+    memset(table, 0xFF, sizeof(table));
+
+    while (i + 4 <= len) {
+        memcpy(&word, src + i, 4);
+        h = (word * 2654435761u) >> (32 - HASH_BITS);
+        cand = table[h];
+        table[h] = i;
+
+        if (cand < 0 || i - cand > MAX_OFFSET || memcmp(src + cand, src + i, 4) != 0) {
+            i++;
+            continue;
+        }
+
+        for (mlen = 4; i + mlen < len && src[cand + mlen] == src[i + mlen]; mlen++);
+
+        lits = i - anchor;
+        if (out >= cap)
+            return 0;
+        dst[out++] = ((lits < 15 ? lits : 15) << 4) | (mlen - 4 < 15 ? mlen - 4 : 15);
+        if (lits >= 15) {
+            if (0 == (n = put_length(dst + out, cap - out, lits - 15)))
+                return 0;
+            out += n;
+        }
+        if (lits + 2 > cap - out)
+            return 0;
+        memcpy(dst + out, src + anchor, lits);
+        out += lits;
+        dst[out++] = (i - cand) & 0xFF;
+        dst[out++] = (i - cand) >> 8;
+        if (mlen - 4 >= 15) {
+            if (0 == (n = put_length(dst + out, cap - out, mlen - 4 - 15)))
+                return 0;
+            out += n;
+        }
+
+        i += mlen;
+        anchor = i;
+    }
+
+    /* trailing literals */
+    lits = len - anchor;
+    if (lits > 0) {
+        if (out >= cap)
+            return 0;
+        dst[out++] = (lits < 15 ? lits : 15) << 4;
+        if (lits >= 15) {
+            if (0 == (n = put_length(dst + out, cap - out, lits - 15)))
+                return 0;
+            out += n;
+        }
+        if (lits > cap - out)
+            return 0;
+        memcpy(dst + out, src + anchor, lits);
+        out += lits;
+    }
+
+    return out < cap ? out : 0;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    uint32_t *boot, *node, *new_node;
+    uint8_t *out, *stream, *raw;
+    uint8_t check[BLOCK_SIZE];
+    uint32_t inode, i, length, blocks, size, enc, total;
+    uint32_t raw_blocks, stream_len, out_blocks, files_packed, dir_blocks;
+    uint32_t *offsets;
+    uint8_t *compress;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <input image> <output image>\n", argv[0]);
+        return 1;
+    }
+
+    if (NULL == (image = load_image(argv[1], &image_size)))
+        return 1;
+
+    boot = (uint32_t *)image;
+    num_inodes = boot[BOOT_NUM_INODES];
+    num_datablocks = boot[BOOT_NUM_DATABLOCKS];
+    if ((uint64_t)BLOCK_SIZE * (1 + num_inodes + num_datablocks) > image_size) {
+        fprintf(stderr, "%s: image is truncated\n", argv[1]);
+        return 1;
+    }
+    /* extended directory and its hash table follow the data blocks */
+    dir_blocks = 0;
+    if (boot[BOOT_DIR_MAGIC] == DIR_MAGIC) {
+        dir_blocks = boot[BOOT_DIR_BLOCKS] + (boot[BOOT_DIR_HASH_SIZE] * 4 + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        if ((uint64_t)BLOCK_SIZE * (1 + num_inodes + num_datablocks + dir_blocks) > image_size) {
+            fprintf(stderr, "%s: extended directory is truncated\n", argv[1]);
+            return 1;
+        }
+    }
+    for (inode = 0; inode < num_inodes; inode++) {
+        node = inode_words(inode);
+        if (node[0] & INODE_COMPRESSED) {
+            fprintf(stderr, "%s: image is already compressed\n", argv[1]);
+            return 1;
+        }
+        for (i = 0; i < (node[0] + BLOCK_SIZE - 1) / BLOCK_SIZE; i++) {
+            if (i >= INODE_BLOCKS || node[1 + i] >= num_datablocks) {
+                fprintf(stderr, "%s: inode %u has a bad block\n", argv[1], inode);
+                return 1;
+            }
+        }
+    }
+
+    /* the output never needs more data than the input */
+    out = calloc(1 + num_inodes + num_datablocks + dir_blocks, BLOCK_SIZE);
+    stream = malloc((uint64_t)num_datablocks * BLOCK_SIZE + 1);
+    raw = malloc((uint64_t)num_datablocks * BLOCK_SIZE + 1);
+    offsets = malloc(sizeof(uint32_t) * (INODE_BLOCKS + 1) * (num_inodes + 1));
+    compress = calloc(num_inodes + 1, 1);
+    if (out == NULL || stream == NULL || raw == NULL || offsets == NULL || compress == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    memcpy(out, image, BLOCK_SIZE);
+
+    /* encode every file, keeping the ones that shrink by at least a block */
+    stream_len = 0;
+    raw_blocks = 0;
+    files_packed = 0;
+    for (inode = 0; inode < num_inodes; inode++) {
+        node = inode_words(inode);
+        length = node[0];
+        blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        /* the end offset needs a data_blocks slot of its own */
+        if (blocks > 0 && blocks < INODE_BLOCKS) {
+            total = 0;
+            for (i = 0; i < blocks; i++) {
+                size = (length - i * BLOCK_SIZE > BLOCK_SIZE) ? BLOCK_SIZE : length - i * BLOCK_SIZE;
+                enc = lz_encode(data_block(node[1 + i]), size, stream + stream_len + total, size);
+                if (enc == 0) {
+                    memcpy(stream + stream_len + total, data_block(node[1 + i]), size);
+                    enc = size;
+                } else if (lz_decode(stream + stream_len + total, enc, check, size) != size
+                           || memcmp(check, data_block(node[1 + i]), size) != 0) {
+                    fprintf(stderr, "inode %u block %u does not round trip\n", inode, i);
+                    return 1;
+                }
+                offsets[inode * (INODE_BLOCKS + 1) + i] = total;
+                total += enc;
+            }
+            offsets[inode * (INODE_BLOCKS + 1) + blocks] = total;
+
+            if (total + BLOCK_SIZE <= blocks * BLOCK_SIZE) {
+                compress[inode] = 1;
+                for (i = 0; i <= blocks; i++)
+                    offsets[inode * (INODE_BLOCKS + 1) + i] += stream_len;
+                stream_len += total;
+                files_packed++;
+                continue;
+            }
+        }
+
+        raw_blocks += blocks;
+    }
+
+    /* uncompressed files first so their blocks stay page aligned, then the packed stream */
+    out_blocks = 0;
+    for (inode = 0; inode < num_inodes; inode++) {
+        node = inode_words(inode);
+        new_node = (uint32_t *)(out + BLOCK_SIZE * (inode + 1));
+        length = node[0];
+        blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        if (compress[inode]) {
+            new_node[0] = length | INODE_COMPRESSED;
+            for (i = 0; i <= blocks; i++)
+                new_node[1 + i] = offsets[inode * (INODE_BLOCKS + 1) + i] + raw_blocks * BLOCK_SIZE;
+            continue;
+        }
+
+        new_node[0] = length;
+        for (i = 0; i < blocks; i++) {
+            memcpy(raw + out_blocks * BLOCK_SIZE, data_block(node[1 + i]), BLOCK_SIZE);
+            new_node[1 + i] = out_blocks++;
+        }
+    }
+
+    memcpy(raw + raw_blocks * BLOCK_SIZE, stream, stream_len);
+    out_blocks = raw_blocks + (stream_len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    memcpy(out + BLOCK_SIZE * (1 + num_inodes), raw, (uint64_t)out_blocks * BLOCK_SIZE);
+    ((uint32_t *)out)[BOOT_NUM_DATABLOCKS] = out_blocks;
+    memcpy(out + BLOCK_SIZE * (1 + num_inodes + out_blocks), data_block(num_datablocks), (uint64_t)dir_blocks * BLOCK_SIZE);
+
+    if (NULL == (f = fopen(argv[2], "wb"))
+        || fwrite(out, BLOCK_SIZE, 1 + num_inodes + out_blocks + dir_blocks, f) != 1 + num_inodes + out_blocks + dir_blocks
+        || fclose(f) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("%u of %u files compressed, %u data blocks -> %u, %u -> %u bytes\n",
+           files_packed, num_inodes, num_datablocks, out_blocks,
+           (1 + num_inodes + num_datablocks + dir_blocks) * BLOCK_SIZE,
+           (1 + num_inodes + out_blocks + dir_blocks) * BLOCK_SIZE);
+    return 0;
+}
@@ -0,0 +1,274 @@
+/*
+ * fsckfs - checks a file system image and reports its layout.
+ *
+ * Usage: fsckfs [-b] <image>
+ *
+ * Checks the boot block, the directory (including an extended directory
+ * and its hash table), every inode a directory entry refers to, and that
+ * no data block belongs to two inodes.  Compressed files are decoded
+ * block by block.  For each file it reports how many runs of consecutive
+ * data blocks it is split into, since read_data copies one run per
+ * memcpy.  With -b it also times a host copy of read_data over each file.
+ * Exits with status 1 if any error was found.
+ */
+
+#include <time.h>
+
+#include "fsimage.h"
+
+#define BENCH_NS 20000000ULL    /* time each file for at least 20 ms */
+
+static uint8_t *image;
+static uint32_t image_size;
+static uint32_t num_inodes, num_datablocks;
+static int errors;
+
+static uint32_t *inode_words(uint32_t inode)
+{
+    return (uint32_t *)(image + BLOCK_SIZE * (inode + 1));
+}
+
+static uint8_t *data_start(void)
+{
+    return image + BLOCK_SIZE * (num_inodes + 1);
+}
+
+static void error(const char *fmt, const char *name, uint32_t value)
+{
+    printf("error: ");
+    printf(fmt, name, value);
+    printf("\n");
+    errors++;
+}
+
+/*
+ * Host copy of read_data: reads a whole file, one memcpy per run of
+ * consecutive blocks, or one decode per block if it is compressed.
+ */
+static int32_t read_file(uint32_t inode, uint8_t *buf)
+{
+    uint32_t *node = inode_words(inode);
+    uint32_t length = node[0] & INODE_LENGTH_MASK;
+    uint32_t copied = 0, index = 0, run, chunk, size;
+
+    while (copied < length) {
+        if (node[0] & INODE_COMPRESSED) {
+            size = (length - copied > BLOCK_SIZE) ? BLOCK_SIZE : length - copied;
+            chunk = node[2 + index] - node[1 + index];
+            if (chunk == size)
+                memcpy(buf + copied, data_start() + node[1 + index], size);
+            else if (lz_decode(data_start() + node[1 + index], chunk, buf + copied, size) != size)
+                return -1;
+            copied += size;
+            index++;
+            continue;
+        }
+
+        for (run = 1; copied + run * BLOCK_SIZE < length && node[1 + index + run] == node[1 + index] + run; run++);
+        chunk = run * BLOCK_SIZE;
+        if (chunk > length - copied)
+            chunk = length - copied;
+        memcpy(buf + copied, data_start() + BLOCK_SIZE * node[1 + index], chunk);
+        copied += chunk;
+        index += run;
+    }
+    return copied;
+}
+
+/* Checks one inode and marks its blocks used; returns the number of runs, 0 if it is bad */
+static uint32_t check_inode(const char *name, uint32_t inode, uint8_t *used)
+{
+    uint32_t *node = inode_words(inode);
+    uint32_t length = node[0] & INODE_LENGTH_MASK;
+    uint32_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint32_t i, runs, size;
+    uint8_t check[BLOCK_SIZE];
+
+    if (blocks > INODE_BLOCKS || ((node[0] & INODE_COMPRESSED) && blocks >= INODE_BLOCKS)) {
+        error("%s: length %u is too large", name, length);
+        return 0;
+    }
+
+    if (node[0] & INODE_COMPRESSED) {
+        for (i = 0; i < blocks; i++) {
+            size = (length - i * BLOCK_SIZE > BLOCK_SIZE) ? BLOCK_SIZE : length - i * BLOCK_SIZE;
+            if (node[2 + i] < node[1 + i] || node[2 + i] > num_datablocks * BLOCK_SIZE
+                || node[2 + i] - node[1 + i] > size) {
+                error("%s: compressed block %u is out of range", name, i);
+                return 0;
+            }
+            if (node[2 + i] - node[1 + i] < size
+                && lz_decode(data_start() + node[1 + i], node[2 + i] - node[1 + i], check, size) != size) {
+                error("%s: compressed block %u does not decode", name, i);
+                return 0;
+            }
+        }
+        for (i = node[1] / BLOCK_SIZE; blocks > 0 && i <= (node[1 + blocks] - 1) / BLOCK_SIZE; i++)
+            used[i] = 1;    /* packed blocks can share data blocks with other compressed files */
+        return 1;
+    }
+
+    runs = 0;
+    for (i = 0; i < blocks; i++) {
+        if (node[1 + i] >= num_datablocks) {
+            error("%s: data block %u is out of range", name, node[1 + i]);
+            return 0;
+        }
+        if (used[node[1 + i]]) {
+            error("%s: data block %u belongs to another inode", name, node[1 + i]);
+            return 0;
+        }
+        used[node[1 + i]] = 1;
+        if (i == 0 || node[1 + i] != node[i] + 1)
+            runs++;
+    }
+    return runs;
+}
+
+static double time_read(uint32_t inode, uint8_t *buf, uint32_t length)
+{
+    struct timespec start, now;
+    uint64_t elapsed, rounds = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        read_file(inode, buf);
+        rounds++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (now.tv_sec - start.tv_sec) * 1000000000ULL + now.tv_nsec - start.tv_nsec;
+    } while (elapsed < BENCH_NS);
+
+    return (double)length * rounds / 1048576.0 / (elapsed / 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t *boot, *hash = NULL;
+    uint8_t *entries, *entry, *used, *seen, *buf;
+    char name[FNAME_MAX_LEN + 1];
+    uint32_t nentries, hash_size = 0, type, inode, length, runs, slot, probes;
+    uint32_t i, j, files = 0, contiguous = 0, unused = 0;
+    int bench = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-b") == 0) {
+        bench = 1;
+        argv++;
+        argc--;
+    }
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s [-b] <image>\n", argv[0]);
+        return 1;
+    }
+    if (NULL == (image = load_image(argv[1], &image_size)))
+        return 1;
+
+    boot = (uint32_t *)image;
+    num_inodes = boot[BOOT_NUM_INODES];
+    num_datablocks = boot[BOOT_NUM_DATABLOCKS];
+    if (boot[BOOT_NUM_ENTRIES] > DENTRY_COUNT || num_inodes > image_size / BLOCK_SIZE
+        || num_datablocks > image_size / BLOCK_SIZE
+        || (uint64_t)BLOCK_SIZE * (1 + num_inodes + num_datablocks) > image_size) {
+        printf("error: boot block does not match the image size\n");
+        return 1;
+    }
+
+    /* the directory the kernel will use */
+    entries = image + DENTRY_SIZE;
+    nentries = boot[BOOT_NUM_ENTRIES];
+    if (boot[BOOT_DIR_MAGIC] == DIR_MAGIC) {
+        hash_size = boot[BOOT_DIR_HASH_SIZE];
+        if (hash_size == 0 || (hash_size & (hash_size - 1)) != 0 || hash_size <= boot[BOOT_DIR_ENTRIES]
+            || boot[BOOT_DIR_BLOCKS] < (boot[BOOT_DIR_ENTRIES] * (uint64_t)DENTRY_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE
+            || BLOCK_SIZE * (1 + num_inodes + num_datablocks + (uint64_t)boot[BOOT_DIR_BLOCKS])
+               + hash_size * 4ULL > image_size) {
+            printf("error: extended directory header is bad, the kernel will ignore it\n");
+            errors++;
+        } else {
+            entries = image + BLOCK_SIZE * (1 + num_inodes + num_datablocks);
+            nentries = boot[BOOT_DIR_ENTRIES];
+            hash = (uint32_t *)(entries + BLOCK_SIZE * boot[BOOT_DIR_BLOCKS]);
+            if (memcmp(image + DENTRY_SIZE, entries, boot[BOOT_NUM_ENTRIES] * DENTRY_SIZE) != 0)
+                printf("warning: boot block entries differ from the extended directory\n");
+        }
+    }
+
+    used = calloc(num_datablocks + 1, 1);
+    seen = calloc(num_inodes + 1, 1);
+    buf = malloc(INODE_BLOCKS * BLOCK_SIZE);
+    if (used == NULL || seen == NULL || buf == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("%-32s %5s %7s %5s%s\n", "name", "inode", "bytes", "runs", bench ? "     MiB/s" : "");
+    for (i = 0; i < nentries; i++) {
+        entry = entries + i * DENTRY_SIZE;
+        memcpy(name, entry, FNAME_MAX_LEN);
+        name[FNAME_MAX_LEN] = '\0';
+        type = ((uint32_t *)entry)[DENTRY_TYPE];
+        inode = ((uint32_t *)entry)[DENTRY_INODE];
+
+        if (name[0] == '\0')
+            error("entry %s%u has no name", "", i);
+        for (j = 0; j < i; j++) {
+            if (strncmp(name, (char *)entries + j * DENTRY_SIZE, FNAME_MAX_LEN) == 0) {
+                error("%s: duplicate name (entry %u)", name, i);
+                break;
+            }
+        }
+
+        /* every entry has to be reachable through the hash table */
+        if (hash != NULL) {
+            slot = dentry_hash(entry) & (hash_size - 1);
+            for (probes = 0; probes < hash_size && hash[slot] != 0 && hash[slot] != i + 1; probes++)
+                slot = (slot + 1) & (hash_size - 1);
+            if (hash[slot] != i + 1)
+                error("%s: not in the hash table (entry %u)", name, i);
+        }
+
+        if (type == TYPE_RTC || type == TYPE_DIR || type == TYPE_SYSSTAT)
+            continue;
+        if (type != TYPE_FILE) {
+            error("%s: bad type %u", name, type);
+            continue;
+        }
+        if (inode >= num_inodes) {
+            error("%s: inode %u is out of range", name, inode);
+            continue;
+        }
+
+        /* hard links share an inode, check and time it once */
+        if (seen[inode])
+            continue;
+        seen[inode] = 1;
+
+        length = inode_words(inode)[0] & INODE_LENGTH_MASK;
+        runs = check_inode(name, inode, used);
+        if (runs == 0 && length != 0)
+            continue;
+        files++;
+        if (runs <= 1)
+            contiguous++;
+
+        printf("%-32s %5u %7u %5u", name, inode, length, runs);
+        if (bench && length > 0) {
+            if (read_file(inode, buf) != length)
+                error("%s: read %u bytes short", name, length);
+            else
+                printf(" %9.1f", time_read(inode, buf, length));
+        }
+        printf("%s\n", (inode_words(inode)[0] & INODE_COMPRESSED) ? "  compressed" : "");
+    }
+
+    for (i = 0; i < num_inodes; i++)
+        if (!seen[i])
+            unused++;
+    printf("%u entries, %u files, %u contiguous, %u inodes unused, ", nentries, files, contiguous, unused);
+    for (i = 0, unused = 0; i < num_datablocks; i++)
+        if (!used[i])
+            unused++;
+    printf("%u of %u data blocks unused\n", unused, num_datablocks);
+    printf("%s\n", errors ? "ERRORS FOUND" : "clean");
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * fsimage.h - layout of the file system image read by
+ * student-distrib/filesys.c, shared by the host-side image tools.
+ * Everything in an image is a little-endian 32-bit word or a 4 KiB block.
+ *
+ *   block 0                 boot block: header words, then up to 63 dentries
+ *   blocks 1 .. N           inodes: length word, then data block numbers
+ *   blocks N+1 .. N+D       data blocks
+ *   after the data blocks   extended directory, if the header has DIR_MAGIC
+ */
+
+#if !defined(FSIMAGE_H)
+#define FSIMAGE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_SIZE 4096
+#define DENTRY_SIZE 64
+#define DENTRY_COUNT 63
+#define FNAME_MAX_LEN 32
+#define INODE_BLOCKS 1023
+#define INODE_COMPRESSED 0x80000000
+#define INODE_LENGTH_MASK 0x7FFFFFFF
+#define DIR_MAGIC 0x52494458
+
+/* Boot block header, in words */
+#define BOOT_NUM_ENTRIES 0
+#define BOOT_NUM_INODES 1
+#define BOOT_NUM_DATABLOCKS 2
+#define BOOT_DIR_MAGIC 3
+#define BOOT_DIR_ENTRIES 4
+#define BOOT_DIR_BLOCKS 5
+#define BOOT_DIR_HASH_SIZE 6
+
+/* Dentry fields, in words after the 32-byte name */
+#define DENTRY_TYPE 8
+#define DENTRY_INODE 9
+
+#define TYPE_RTC 0
+#define TYPE_DIR 1
+#define TYPE_FILE 2
+#define TYPE_SYSSTAT 3 /* system call statistics, read like the RTC */
+
+/* Same hash as dentry_hash in filesys.c, over at most 32 characters */
+static inline uint32_t dentry_hash(const uint8_t *fname)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    for (i = 0; i < FNAME_MAX_LEN && fname[i] != '\0'; i++) {
+        hash ^= fname[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+/* Host copy of lz_decode in blockcache.c; returns the decoded size or -1 */
+static inline int32_t lz_decode(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_len)
+{
+    uint32_t in = 0, out = 0, count, offset;
+    uint8_t token, ext;
+
+    while (in < src_len) {
+        token = src[in++];
+        count = token >> 4;
+        if (count == 15) {
+            do {
+                if (in >= src_len)
+                    return -1;
+                ext = src[in++];
+                count += ext;
+            } while (ext == 255);
+        }
+        if (count > src_len - in || count > dst_len - out)
+            return -1;
+        memcpy(dst + out, src + in, count);
+        in += count;
+        out += count;
+        if (in == src_len)
+            break;
+        if (src_len - in < 2)
+            return -1;
+        offset = src[in] | (src[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out)
+            return -1;
+        count = (token & 0x0F) + 4;
+        if ((token & 0x0F) == 15) {
+            do {
+                if (in >= src_len)
+                    return -1;
+                ext = src[in++];
+                count += ext;
+            } while (ext == 255);
+        }
+        if (count > dst_len - out)
+            return -1;
+        for (; count > 0; count--, out++)
+            dst[out] = dst[out - offset];
+    }
+    return out;
+}
+
+/* Reads a whole image into memory; returns NULL after printing why on failure */
+static inline uint8_t *load_image(const char *path, uint32_t *size)
+{
+    FILE *f;
+    uint8_t *image;
+    long len;
+
+    if (NULL == (f = fopen(path, "rb"))) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    image = (len >= BLOCK_SIZE) ? malloc(len) : NULL;
+    if (image == NULL || fread(image, 1, len, f) != (size_t)len) {
+        fprintf(stderr, "%s: could not read image\n", path);
+        fclose(f);
+        free(image);
+        return NULL;
+    }
+    fclose(f);
+    *size = len;
+    return image;
+}
+
+#endif /* FSIMAGE_H */